@@ -75,48 +75,133 @@ void App::init_imgui()
 void App::render_tool_gui()
 {
   core_->render_tool_panel();
+  core_->profiler().render_panel();
 }
 
 void App::render_gl_program()
 {
-  core_->render_grid();
-  core_->render_track_boundaries(); // 先渲染赛道边界
-  core_->render_path();             // 然后渲染中心线
-  core_->render_cube();             // 最后渲染车子
+  core_->render_scene();
 }
 
 void App::app_run()
 {
+  double last_time = glfwGetTime();
 
   while (!glfwWindowShouldClose(window_))
   {
     glfwPollEvents();
+
+    // 仿真按实际经过的时间推进，与渲染解耦
+    double now = glfwGetTime();
+    double dt = now - last_time;
+    last_time = now;
+
     if (glfwGetWindowAttrib(window_, GLFW_ICONIFIED) != 0)
     {
       ImGui_ImplGlfw_Sleep(10);
       continue;
     }
 
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
-    ImGui::NewFrame();
+    FrameProfiler &profiler = core_->profiler();
+    profiler.begin_frame();
+
+    {
+      ProfileScope scope(profiler, "update");
+      core_->update(dt);
+    }
+
+    {
+      ProfileScope scope(profiler, "imgui_build");
+      ImGui_ImplOpenGL3_NewFrame();
+      ImGui_ImplGlfw_NewFrame();
+      ImGui::NewFrame();
 
-    render_tool_gui();
-    ImGui::Render();
+      render_tool_gui();
+      ImGui::Render();
+    }
 
     int display_w, display_h;
     glfwGetFramebufferSize(window_, &display_w, &display_h);
     glViewport(0, 0, display_w, display_h);
     glClearColor(clear_color_.x * clear_color_.w, clear_color_.y * clear_color_.w, clear_color_.z * clear_color_.w, clear_color_.w);
     glClear(GL_COLOR_BUFFER_BIT);
+    core_->begin_frame(display_w, display_h);
     render_gl_program();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-    glfwSwapBuffers(window_);
+    if (!capture_path_.empty())
+    {
+      ProfileScope scope(profiler, "capture");
+      capture_frame(display_w, display_h);
+    }
+    {
+      ProfileScope scope(profiler, "imgui_render", true);
+      ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    }
+    {
+      // 包含等待垂直同步的时间
+      ProfileScope scope(profiler, "swap_buffers");
+      glfwSwapBuffers(window_);
+    }
   }
 }
 
+bool App::load_path_file(const std::string &file_path)
+{
+  return core_->load_path_file(file_path);
+}
+
+void App::set_clip_planes(float near_plane, float far_plane)
+{
+  core_->set_clip_planes(near_plane, far_plane);
+}
+
+void App::set_playback(double play_speed, float step_rate)
+{
+  Simulation &simulation = core_->simulation();
+  simulation.set_play_speed(play_speed);
+  simulation.set_step_rate(step_rate);
+}
+
+void App::set_capture(CaptureFormat format, const std::string &path)
+{
+  capture_format_ = format;
+  capture_path_ = path;
+}
+
+void App::capture_frame(int width, int height)
+{
+  if (capture_width_ == 0)
+  {
+    // Y4M 需要帧率，按显示器刷新率（垂直同步下的实际帧率）
+    const GLFWvidmode *mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    const double fps = mode != nullptr && mode->refreshRate > 0 ? mode->refreshRate : 60.0;
+    if (!capture_.open(capture_format_, capture_path_, width, height, fps))
+    {
+      capture_path_.clear();
+      return;
+    }
+    capture_width_ = width;
+    capture_height_ = height;
+  }
+
+  if (width != capture_width_ || height != capture_height_)
+  {
+    capture_skipped_++;
+    return;
+  }
+  capture_.capture();
+}
+
 void App::app_exit()
 {
+  if (capture_.is_open())
+  {
+    // 录制可能写到标准输出，统计写到标准错误
+    capture_.close();
+    std::cerr << "Capture: " << capture_.written() << " frames written, " << capture_.dropped() << " dropped ("
+              << capture_.dropped_readback() << " readback, " << capture_.dropped_encode() << " encode), "
+              << capture_skipped_ << " skipped after resize" << std::endl;
+  }
+
   ImGui_ImplOpenGL3_Shutdown();
   ImGui_ImplGlfw_Shutdown();
   ImGui::DestroyContext();
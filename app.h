@@ -9,6 +9,7 @@
 #include <functional>
 
 #include "core.h"
+#include "frame_capture.h"
 
 class App
 {
@@ -21,10 +22,22 @@ private:
   GLFWwindow *window_;
   Core *core_;
 
+  // 录制：第一帧时按帧缓冲尺寸打开，窗口尺寸变化后的帧跳过。界面面板不录进去
+  FrameCapture capture_;
+  CaptureFormat capture_format_ = CaptureFormat::kPngSequence;
+  std::string capture_path_;
+  int capture_width_ = 0;
+  int capture_height_ = 0;
+  size_t capture_skipped_ = 0;
+
 public:
   App(const char *title, int width, int height);
   ~App() = default;
 
+  bool load_path_file(const std::string &file_path);
+  void set_capture(CaptureFormat format, const std::string &path); // 在 app_run 之前调用
+  void set_clip_planes(float near_plane, float far_plane);
+  void set_playback(double play_speed, float step_rate); // 初始播放速度倍率和仿真频率
   void app_run();
   void app_exit();
 
@@ -32,6 +45,7 @@ private:
   void init_imgui();
   void render_tool_gui();
   void render_gl_program();
+  void capture_frame(int width, int height);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "fleet.h"
+#include "simulation.h"
+#include "task_pool.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// 车队并行更新的扩展性测试：线程数从 1 增加到 N，统计每个仿真步的耗时和加速比
+
+static void print_usage(const char *program)
+{
+  std::cout << "Usage: " << program << " [--vehicles <车辆数>] [--ticks <步数>] [--threads <最大线程数>]\n"
+            << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+  size_t vehicle_count = 100000;
+  int tick_count = 600;
+  size_t max_threads = TaskPool::default_worker_count() + 1;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    bool has_value = i + 1 < argc;
+
+    if (strcmp(arg, "--vehicles") == 0 && has_value)
+    {
+      vehicle_count = (size_t)atol(argv[++i]);
+    }
+    else if (strcmp(arg, "--ticks") == 0 && has_value)
+    {
+      tick_count = atoi(argv[++i]);
+    }
+    else if (strcmp(arg, "--threads") == 0 && has_value)
+    {
+      max_threads = (size_t)atol(argv[++i]);
+    }
+    else
+    {
+      print_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (vehicle_count == 0 || tick_count <= 0 || max_threads == 0)
+  {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  Simulation simulation;
+  simulation.init_predefined_path();
+
+  const double fixed_dt = 1.0 / simulation.step_rate();
+  double single_thread_ms = 0.0;
+
+  printf("vehicles %zu, ticks %d\n", vehicle_count, tick_count);
+  printf("%8s %12s %10s %10s\n", "threads", "ms/tick", "speedup", "efficiency");
+
+  for (size_t threads = 1; threads <= max_threads; threads++)
+  {
+    TaskPool pool(threads - 1);
+    Fleet fleet;
+    FleetSnapshot snapshot;
+    fleet.set_path(simulation.path());
+    fleet.populate(vehicle_count);
+
+    // 预热：分配快照、唤醒工作线程
+    for (int tick = 0; tick < 10; tick++)
+    {
+      fleet.step(fixed_dt, pool, &snapshot);
+    }
+
+    using clock = std::chrono::steady_clock;
+    const clock::time_point start = clock::now();
+    for (int tick = 0; tick < tick_count; tick++)
+    {
+      fleet.step(fixed_dt, pool, &snapshot);
+    }
+    const double ms_per_tick = std::chrono::duration<double, std::milli>(clock::now() - start).count() / tick_count;
+
+    if (threads == 1)
+    {
+      single_thread_ms = ms_per_tick;
+    }
+    double speedup = single_thread_ms / ms_per_tick;
+    printf("%8zu %12.4f %10.2f %9.0f%%\n", threads, ms_per_tick, speedup, speedup / threads * 100.0);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+#include "interpolation.h"
+#include "simulation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+// 批量插值内核与逐点插值函数的对比：每辆车处于路径上的随机位置，统计每辆车的平均耗时
+
+static void print_usage(const char *program)
+{
+  std::cout << "Usage: " << program << " [--vehicles <车辆数>] [--repeats <次数>]\n"
+            << std::endl;
+}
+
+// 改写前的逐点角度插值（用循环规整），作为对比基准
+static float legacy_interpolate_yaw(float yaw1, float yaw2, float t)
+{
+  float diff = yaw2 - yaw1;
+  if (diff > 180.0f)
+  {
+    diff -= 360.0f;
+  }
+  else if (diff < -180.0f)
+  {
+    diff += 360.0f;
+  }
+
+  float result = yaw1 + diff * t;
+  while (result > 180.0f)
+    result -= 360.0f;
+  while (result < -180.0f)
+    result += 360.0f;
+  return result;
+}
+
+// 多次运行取最快的一次，返回每辆车的纳秒数
+static double time_per_vehicle(const std::function<void()> &run, size_t vehicle_count, int repeats)
+{
+  using clock = std::chrono::steady_clock;
+  double best = 1e30;
+  for (int i = 0; i < repeats; i++)
+  {
+    const clock::time_point start = clock::now();
+    run();
+    best = std::min(best, std::chrono::duration<double, std::nano>(clock::now() - start).count());
+  }
+  return best / vehicle_count;
+}
+
+int main(int argc, char **argv)
+{
+  size_t vehicle_count = 1000000;
+  int repeats = 20;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    bool has_value = i + 1 < argc;
+
+    if (strcmp(arg, "--vehicles") == 0 && has_value)
+    {
+      vehicle_count = (size_t)atol(argv[++i]);
+    }
+    else if (strcmp(arg, "--repeats") == 0 && has_value)
+    {
+      repeats = atoi(argv[++i]);
+    }
+    else
+    {
+      print_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (vehicle_count == 0 || repeats <= 0)
+  {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  Simulation simulation;
+  simulation.init_predefined_path();
+  const PathView &path = simulation.path();
+  const size_t point_count = path.size();
+
+  // 车辆随机分布在路径上，没有车道偏移，便于和逐点函数比较结果；段内进度预先算好，两种方式读同一份输入
+  const double duration = path.back().timestamp;
+  std::vector<float> progress(vehicle_count), lateral_offsets(vehicle_count, 0.0f);
+  std::vector<int> indices(vehicle_count);
+  for (size_t i = 0; i < vehicle_count; i++)
+  {
+    uint32_t hash = (uint32_t)i * 2654435761u;
+    double time = duration * (double)(hash >> 8) / (double)(1u << 24);
+    int i0 = simulation.find_path_segment(time);
+    double segment_duration = path[i0 + 1].timestamp - path[i0].timestamp;
+    double t = segment_duration > 0.0 ? (time - path[i0].timestamp) / segment_duration : 0.0;
+    indices[i] = i0;
+    progress[i] = (float)std::min(std::max(t, 0.0), 1.0);
+  }
+
+  std::vector<float> expected_x(vehicle_count), expected_y(vehicle_count), expected_z(vehicle_count), expected_yaw(vehicle_count);
+  std::vector<float> out_x(vehicle_count), out_y(vehicle_count), out_z(vehicle_count), out_yaw(vehicle_count);
+
+  const VehicleColumns vehicle_columns = {progress.data(), indices.data(), lateral_offsets.data(),
+                                          out_x.data(), out_y.data(), out_z.data(), out_yaw.data()};
+
+  // 逐点调用插值函数，legacy 为真时使用改写前的角度插值
+  auto run_per_point = [&](bool legacy) {
+    for (size_t i = 0; i < vehicle_count; i++)
+    {
+      const int i0 = indices[i];
+      const float t = progress[i];
+      glm::vec3 position = simulation.interpolate_position(path[i0], path[i0 + 1], t);
+      out_x[i] = position.x;
+      out_y[i] = position.y;
+      out_z[i] = position.z;
+      out_yaw[i] = legacy ? legacy_interpolate_yaw(path[i0].yaw, path[i0 + 1].yaw, t)
+                          : simulation.interpolate_yaw(path[i0].yaw, path[i0 + 1].yaw, t);
+    }
+  };
+
+  // 与改写前的结果比较，角度差按最短弧计算
+  auto max_error = [&]() {
+    float error = 0.0f;
+    for (size_t i = 0; i < vehicle_count; i++)
+    {
+      error = std::max(error, std::abs(out_x[i] - expected_x[i]));
+      error = std::max(error, std::abs(out_y[i] - expected_y[i]));
+      error = std::max(error, std::abs(out_z[i] - expected_z[i]));
+      error = std::max(error, std::abs(shortest_yaw_delta(expected_yaw[i], out_yaw[i])));
+    }
+    return error;
+  };
+
+  printf("vehicles %zu, path points %zu, best of %d\n", vehicle_count, point_count, repeats);
+  printf("%-20s %12s %10s %12s\n", "variant", "ns/vehicle", "speedup", "max error");
+
+  const double legacy_ns = time_per_vehicle([&]() { run_per_point(true); }, vehicle_count, repeats);
+  expected_x = out_x;
+  expected_y = out_y;
+  expected_z = out_z;
+  expected_yaw = out_yaw;
+  printf("%-20s %12.3f %10.2f %12g\n", "per-point legacy", legacy_ns, 1.0, 0.0);
+
+  double ns = time_per_vehicle([&]() { run_per_point(false); }, vehicle_count, repeats);
+  printf("%-20s %12.3f %10.2f %12g\n", "per-point", ns, legacy_ns / ns, max_error());
+
+  const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2};
+  for (SimdLevel level : levels)
+  {
+    if (!simd_level_supported(level))
+    {
+      printf("%-20s %12s\n", (std::string("batch ") + simd_level_name(level)).c_str(), "unsupported");
+      continue;
+    }
+
+    ns = time_per_vehicle([&]() { interpolate_batch(level, path, vehicle_columns, 0, vehicle_count); },
+                          vehicle_count, repeats);
+    printf("%-20s %12.3f %10.2f %12g\n", (std::string("batch ") + simd_level_name(level)).c_str(), ns, legacy_ns / ns,
+           max_error());
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,485 @@
+#include "core.h"
+#include "fleet.h"
+#include "offscreen_context.h"
+#include "path_chunks.h"
+#include "path_file.h"
+#include "simulation.h"
+#include "task_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// 综合性能测试：路径播放、轨迹记录、赛道分块生成、车队推进随规模的变化，以及离屏 GL 上下文中各渲染流程的耗时。
+// 结果以 JSON 输出，便于与历史结果比较
+
+using bench_clock = std::chrono::steady_clock;
+
+static void print_usage(const char *program)
+{
+  std::cout << "Usage: " << program << " [--sizes <路径点数,...>] [--fleet <车辆数,...>] [--trail <轨迹容量,...>]\n"
+            << "       [--frames <帧数>] [--width <像素>] [--height <像素>] [--render-fleet <车辆数>]\n"
+            << "       [--scratch <临时目录>] [--no-gl] [--output <文件>]\n"
+            << std::endl;
+}
+
+// 逗号分隔的正整数列表
+static bool parse_list(const char *text, std::vector<size_t> &values)
+{
+  values.clear();
+  std::stringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ','))
+  {
+    long long value = atoll(item.c_str());
+    if (value <= 0)
+    {
+      return false;
+    }
+    values.push_back((size_t)value);
+  }
+  return !values.empty();
+}
+
+static double elapsed_ms(bench_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+}
+
+// 合成路径：10 m/s 沿带波纹的圆周行驶，每圈半径略增，任意点数都不会首尾重叠，也不会离原点太远
+static std::vector<PathPoint> make_path(size_t point_count)
+{
+  const float spacing = 0.5f;    // 米
+  const double time_step = 0.05; // 秒
+  const double base_radius = 1500.0;
+
+  std::vector<PathPoint> path(point_count);
+  double angle = 0.0;
+  for (size_t i = 0; i < point_count; i++)
+  {
+    const double lap = angle / (2.0 * M_PI);
+    const double radius = base_radius + 3.0 * lap + 20.0 * sin(8.0 * angle);
+    path[i].position = glm::vec3((float)(radius * cos(angle)), 0.0f, (float)(radius * sin(angle)));
+    path[i].timestamp = i * time_step;
+    angle += spacing / radius;
+  }
+  for (size_t i = 0; i < point_count; i++)
+  {
+    glm::vec3 direction = i + 1 < point_count ? path[i + 1].position - path[i].position : path[i].position - path[i - 1].position;
+    path[i].yaw = glm::degrees(atan2(direction.x, direction.z));
+  }
+  return path;
+}
+
+// 一组逐帧耗时的统计
+struct FrameStats
+{
+  double mean = 0.0;
+  double p50 = 0.0;
+  double p95 = 0.0;
+};
+
+static FrameStats frame_stats(std::vector<double> values)
+{
+  FrameStats stats;
+  if (values.empty())
+  {
+    return stats;
+  }
+  std::sort(values.begin(), values.end());
+  double sum = 0.0;
+  for (double value : values)
+    sum += value;
+  stats.mean = sum / values.size();
+  stats.p50 = values[values.size() / 2];
+  stats.p95 = values[std::min((size_t)(values.size() * 0.95), values.size() - 1)];
+  return stats;
+}
+
+static void write_stats(std::ostream &out, const char *name, const FrameStats &stats)
+{
+  out << "\"" << name << "\": {\"mean\": " << stats.mean << ", \"p50\": " << stats.p50 << ", \"p95\": " << stats.p95 << "}";
+}
+
+// 路径播放：每步的推进（含轨迹记录）和任意跳转的耗时
+static void bench_playback(std::ostream &out, size_t point_count)
+{
+  std::vector<PathPoint> path = make_path(point_count);
+  Simulation simulation;
+  simulation.set_path(path);
+  simulation.set_loop_play(true);
+  simulation.start_path_playback();
+
+  const double fixed_dt = 1.0 / simulation.step_rate();
+  const int step_count = 200000;
+  bench_clock::time_point start = bench_clock::now();
+  for (int i = 0; i < step_count; i++)
+  {
+    simulation.update_path_playback(fixed_dt);
+  }
+  const double step_ms = elapsed_ms(start);
+
+  // 跳转走二分查找，路径越长越依赖缓存
+  std::mt19937 random(12345);
+  std::uniform_real_distribution<double> time_distribution(0.0, simulation.path_duration());
+  const int seek_count = 100000;
+  start = bench_clock::now();
+  for (int i = 0; i < seek_count; i++)
+  {
+    simulation.seek(time_distribution(random));
+  }
+  const double seek_ms = elapsed_ms(start);
+
+  out << "    {\"path_points\": " << point_count << ", \"ns_per_step\": " << step_ms * 1e6 / step_count
+      << ", \"ns_per_seek\": " << seek_ms * 1e6 / seek_count << "}";
+}
+
+// 轨迹记录：写入环形缓冲区的耗时，写满后每次覆盖最旧的点
+static void bench_traveled_path(std::ostream &out, size_t capacity)
+{
+  Simulation simulation;
+  simulation.set_trail_capacity(capacity);
+
+  const size_t push_count = std::max(capacity * 2, (size_t)100000);
+  bench_clock::time_point start = bench_clock::now();
+  for (size_t i = 0; i < push_count; i++)
+  {
+    simulation.set_position(glm::vec3((float)(i % 100000) * 0.1f, 0.0f, (float)(i / 100000)));
+    simulation.update_traveled_path();
+  }
+  const double push_ms = elapsed_ms(start);
+
+  out << "    {\"capacity\": " << capacity << ", \"ns_per_push\": " << push_ms * 1e6 / push_count << "}";
+}
+
+// 赛道分块：逐块生成边界和细节层级（后台线程），统计全部分块的总耗时
+static void bench_track_generation(std::ostream &out, size_t point_count)
+{
+  std::vector<PathPoint> path = make_path(point_count);
+  PathChunkStore store;
+  store.set_path(path, nullptr);
+  store.set_window(0, 0);
+
+  const size_t chunk_count = store.chunk_count();
+  size_t vertex_count = 0;
+  size_t lod_index_count = 0;
+  bench_clock::time_point start = bench_clock::now();
+  for (size_t chunk = 0; chunk < chunk_count; chunk++)
+  {
+    const size_t point_index = chunk * store.chunk_size();
+    store.update(point_index);
+    while (store.resident().count(chunk) == 0)
+    {
+      std::this_thread::yield();
+      store.update(point_index);
+    }
+    const PathChunk &built = *store.resident().at(chunk);
+    vertex_count += built.track_vertices.size();
+    lod_index_count += built.lod_indices.size();
+  }
+  const double total_ms = elapsed_ms(start);
+
+  out << "    {\"path_points\": " << point_count << ", \"chunks\": " << chunk_count << ", \"total_ms\": " << total_ms
+      << ", \"ns_per_point\": " << total_ms * 1e6 / point_count << ", \"track_vertices\": " << vertex_count
+      << ", \"lod_indices\": " << lod_index_count << "}";
+}
+
+// 车队推进：线程池默认线程数下每个仿真步的耗时
+static void bench_fleet(std::ostream &out, size_t vehicle_count, TaskPool &pool)
+{
+  Simulation simulation;
+  simulation.init_predefined_path();
+
+  Fleet fleet;
+  FleetSnapshot snapshot;
+  fleet.set_path(simulation.path());
+  fleet.populate(vehicle_count);
+
+  const double fixed_dt = 1.0 / simulation.step_rate();
+  for (int tick = 0; tick < 10; tick++)
+  {
+    fleet.step(fixed_dt, pool, &snapshot);
+  }
+
+  const int tick_count = 120;
+  bench_clock::time_point start = bench_clock::now();
+  for (int tick = 0; tick < tick_count; tick++)
+  {
+    fleet.step(fixed_dt, pool, &snapshot);
+  }
+  const double ms_per_tick = elapsed_ms(start) / tick_count;
+
+  out << "    {\"vehicles\": " << vehicle_count << ", \"threads\": " << pool.concurrency() << ", \"ms_per_tick\": " << ms_per_tick
+      << ", \"ns_per_vehicle_step\": " << ms_per_tick * 1e6 / vehicle_count << "}";
+}
+
+// 渲染：沿路径播放，逐帧统计 update 和各渲染流程的耗时。每个流程之后 glFinish，
+// 软件渲染时测到的就是该流程的全部代价
+static bool bench_render(std::ostream &out, const OffscreenContext &context, size_t point_count, int frame_count,
+                         int fleet_size, const std::string &scratch_dir)
+{
+  const std::string path_file = scratch_dir + "/spatial_bench_" + std::to_string(point_count) + ".sppath";
+  if (!write_path_file(path_file, make_path(point_count)))
+  {
+    return false;
+  }
+
+  std::vector<double> update_ms, grid_ms, track_ms, path_ms, fleet_ms, cube_ms, frame_ms;
+  {
+    Core core;
+    core.init_core();
+    bool loaded = core.load_path_file(path_file);
+    std::remove(path_file.c_str()); // 已映射，删除目录项不影响读取
+    if (!loaded)
+    {
+      return false;
+    }
+    core.set_fleet_size(fleet_size);
+    core.simulation().set_play_speed(4.0f);
+    core.simulation().start_path_playback();
+
+    const float frame_dt = 1.0f / 60.0f;
+    const int warmup_frames = 60;
+    for (int frame = 0; frame < warmup_frames + frame_count; frame++)
+    {
+      const bool record = frame >= warmup_frames;
+      bench_clock::time_point frame_start = bench_clock::now();
+      auto timed = [&](std::vector<double> &samples, const std::function<void()> &pass) {
+        bench_clock::time_point start = bench_clock::now();
+        pass();
+        glFinish();
+        if (record)
+          samples.push_back(elapsed_ms(start));
+      };
+
+      timed(update_ms, [&]() { core.update(frame_dt); });
+      context.bind_framebuffer();
+      glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+      glClear(GL_COLOR_BUFFER_BIT);
+      core.begin_frame(context.width(), context.height());
+      timed(grid_ms, [&]() { core.render_grid(); });
+      timed(track_ms, [&]() { core.render_track_boundaries(); });
+      timed(path_ms, [&]() { core.render_path(); });
+      timed(fleet_ms, [&]() { core.render_fleet(); });
+      timed(cube_ms, [&]() { core.render_cube(); });
+      if (record)
+        frame_ms.push_back(elapsed_ms(frame_start));
+    }
+  }
+
+  out << "    {\"path_points\": " << point_count << ", \"vehicles\": " << fleet_size << ", \"frames\": " << frame_count << ",\n     ";
+  write_stats(out, "update_ms", frame_stats(update_ms));
+  out << ",\n     ";
+  write_stats(out, "render_grid_ms", frame_stats(grid_ms));
+  out << ",\n     ";
+  write_stats(out, "render_track_boundaries_ms", frame_stats(track_ms));
+  out << ",\n     ";
+  write_stats(out, "render_path_ms", frame_stats(path_ms));
+  out << ",\n     ";
+  write_stats(out, "render_fleet_ms", frame_stats(fleet_ms));
+  out << ",\n     ";
+  write_stats(out, "render_cube_ms", frame_stats(cube_ms));
+  out << ",\n     ";
+  write_stats(out, "frame_ms", frame_stats(frame_ms));
+  out << "}";
+  return true;
+}
+
+// 轨迹渲染：写满指定容量后整体上传、增量上传、生成下标和绘制的耗时
+static void bench_trail_render(std::ostream &out, const OffscreenContext &context, size_t capacity, int frame_count)
+{
+  Core core;
+  core.init_core();
+  Simulation &simulation = core.simulation();
+  simulation.set_trail_capacity(capacity);
+
+  // 向外展开的螺线，每步 0.1 米，超过轨迹的记录阈值
+  float radius = 5.0f;
+  auto extend = [&](size_t count) {
+    for (size_t i = 0; i < count; i++)
+    {
+      simulation.turn(glm::degrees(0.1f / radius));
+      simulation.move_forward(0.1f);
+      radius += 0.0005f;
+    }
+  };
+  extend(capacity);
+
+  bench_clock::time_point start = bench_clock::now();
+  core.update_path_VAO();
+  glFinish();
+  const double full_upload_ms = elapsed_ms(start);
+
+  // 摄像机跟到车辆位置，之后每帧新增 10 个点
+  core.update(0.0f);
+  std::vector<double> upload_ms, indices_ms, draw_ms;
+  for (int frame = 0; frame < frame_count; frame++)
+  {
+    extend(10);
+    start = bench_clock::now();
+    core.update_path_VAO();
+    glFinish();
+    upload_ms.push_back(elapsed_ms(start));
+
+    context.bind_framebuffer();
+    glClear(GL_COLOR_BUFFER_BIT);
+    core.begin_frame(context.width(), context.height());
+
+    start = bench_clock::now();
+    core.update_trail_indices();
+    indices_ms.push_back(elapsed_ms(start));
+
+    // 下标已是最新，这里计的是绘制
+    start = bench_clock::now();
+    core.render_path();
+    glFinish();
+    draw_ms.push_back(elapsed_ms(start));
+  }
+
+  out << "    {\"capacity\": " << capacity << ", \"full_upload_ms\": " << full_upload_ms << ",\n     ";
+  write_stats(out, "incremental_upload_ms", frame_stats(upload_ms));
+  out << ",\n     ";
+  write_stats(out, "update_trail_indices_ms", frame_stats(indices_ms));
+  out << ",\n     ";
+  write_stats(out, "render_path_ms", frame_stats(draw_ms));
+  out << "}";
+}
+
+// 逐项输出 JSON 数组
+static void write_array(std::ostream &out, const char *name, const std::vector<size_t> &values,
+                        const std::function<void(size_t)> &bench, bool last = false)
+{
+  out << "  \"" << name << "\": [\n";
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    std::cerr << name << " " << values[i] << std::endl;
+    bench(values[i]);
+    out << (i + 1 < values.size() ? ",\n" : "\n");
+  }
+  out << "  ]" << (last ? "\n" : ",\n");
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<size_t> path_sizes = {1000, 10000, 100000, 1000000, 10000000};
+  std::vector<size_t> fleet_sizes = {1000, 10000, 100000, 1000000};
+  std::vector<size_t> trail_capacities = {1000, 10000, 100000, 1000000};
+  int frame_count = 240;
+  int width = 1280;
+  int height = 800;
+  int render_fleet = 1000;
+  bool use_gl = true;
+  std::string scratch_dir = ".";
+  std::string output_path;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    bool has_value = i + 1 < argc;
+
+    if (strcmp(arg, "--sizes") == 0 && has_value && parse_list(argv[i + 1], path_sizes))
+    {
+      i++;
+    }
+    else if (strcmp(arg, "--fleet") == 0 && has_value && parse_list(argv[i + 1], fleet_sizes))
+    {
+      i++;
+    }
+    else if (strcmp(arg, "--trail") == 0 && has_value && parse_list(argv[i + 1], trail_capacities))
+    {
+      i++;
+    }
+    else if (strcmp(arg, "--frames") == 0 && has_value)
+    {
+      frame_count = atoi(argv[++i]);
+    }
+    else if (strcmp(arg, "--width") == 0 && has_value)
+    {
+      width = atoi(argv[++i]);
+    }
+    else if (strcmp(arg, "--height") == 0 && has_value)
+    {
+      height = atoi(argv[++i]);
+    }
+    else if (strcmp(arg, "--render-fleet") == 0 && has_value)
+    {
+      render_fleet = atoi(argv[++i]);
+    }
+    else if (strcmp(arg, "--scratch") == 0 && has_value)
+    {
+      scratch_dir = argv[++i];
+    }
+    else if (strcmp(arg, "--no-gl") == 0)
+    {
+      use_gl = false;
+    }
+    else if (strcmp(arg, "--output") == 0 && has_value)
+    {
+      output_path = argv[++i];
+    }
+    else
+    {
+      print_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (frame_count <= 0 || width <= 0 || height <= 0 || render_fleet < 0)
+  {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream output_file;
+  if (!output_path.empty())
+  {
+    output_file.open(output_path);
+    if (!output_file)
+    {
+      std::cout << "ERROR::BENCH::OUTPUT_NOT_WRITABLE: " << output_path << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream &out = output_file.is_open() ? output_file : std::cout;
+
+  // 没有可用的 EGL 时只跑 CPU 部分
+  OffscreenContext context;
+  if (use_gl && !context.create(width, height))
+  {
+    use_gl = false;
+  }
+
+  TaskPool pool;
+  out << "{\n";
+  out << "  \"gl_renderer\": ";
+  if (use_gl)
+    out << "\"" << context.renderer() << "\",\n";
+  else
+    out << "null,\n";
+
+  write_array(out, "playback", path_sizes, [&](size_t size) { bench_playback(out, size); });
+  write_array(out, "traveled_path", trail_capacities, [&](size_t capacity) { bench_traveled_path(out, capacity); });
+  write_array(out, "track_generation", path_sizes, [&](size_t size) { bench_track_generation(out, size); });
+  write_array(out, "fleet", fleet_sizes, [&](size_t size) { bench_fleet(out, size, pool); }, !use_gl);
+
+  if (use_gl)
+  {
+    write_array(out, "render", path_sizes, [&](size_t size) {
+      if (!bench_render(out, context, size, frame_count, render_fleet, scratch_dir))
+        out << "    null";
+    });
+    write_array(out, "trail_render", trail_capacities, [&](size_t capacity) { bench_trail_render(out, context, capacity, frame_count); }, true);
+  }
+  out << "}" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -6,17 +6,27 @@
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
+#ifndef SHADER_DIR
+#define SHADER_DIR "/Users/mds/my/spatial_plane_simulation/glsl/"
 #endif
 
+// 渲染原点取整到的间距（米）。整百米的坐标在 float 中可以精确表示，顶点减去原点没有舍入误差；
+// 它也是地面网格粗线间距的整数倍，网格可以直接在相对坐标上计算
+static const float kRenderOriginCell = 100.0f;
+
 Core::Core()
 {
 }
 
 Core::~Core()
 {
+  // 工作线程可能还在更新车队
+  finish_fleet_update();
+
   if (grid_VAO_ != 0)
   {
     glDeleteVertexArrays(1, &grid_VAO_);
@@ -29,22 +39,54 @@ Core::~Core()
     cube_VAO_ = 0;
   }
 
+  if (cube_VBO_ != 0)
+  {
+    glDeleteBuffers(1, &cube_VBO_);
+    cube_VBO_ = 0;
+  }
+
+  if (fleet_VAO_ != 0)
+  {
+    glDeleteVertexArrays(1, &fleet_VAO_);
+    fleet_VAO_ = 0;
+  }
+
+  if (fleet_instance_VBO_ != 0)
+  {
+    glDeleteBuffers(1, &fleet_instance_VBO_);
+    fleet_instance_VBO_ = 0;
+  }
+
   if (path_VAO_ != 0)
   {
     glDeleteVertexArrays(1, &path_VAO_);
     path_VAO_ = 0;
   }
 
-  if (left_track_VAO_ != 0)
+  if (path_VBO_ != 0)
+  {
+    glDeleteBuffers(1, &path_VBO_);
+    path_VBO_ = 0;
+  }
+
+  if (path_EBO_ != 0)
   {
-    glDeleteVertexArrays(1, &left_track_VAO_);
-    left_track_VAO_ = 0;
+    glDeleteBuffers(1, &path_EBO_);
+    path_EBO_ = 0;
   }
 
-  if (right_track_VAO_ != 0)
+  release_track_chunks();
+
+  if (track_VAO_ != 0)
   {
-    glDeleteVertexArrays(1, &right_track_VAO_);
-    right_track_VAO_ = 0;
+    glDeleteVertexArrays(1, &track_VAO_);
+    track_VAO_ = 0;
+  }
+
+  if (camera_UBO_ != 0)
+  {
+    glDeleteBuffers(1, &camera_UBO_);
+    camera_UBO_ = 0;
   }
 
   if (shader_program_ != 0)
@@ -52,6 +94,24 @@ Core::~Core()
     glDeleteProgram(shader_program_);
     shader_program_ = 0;
   }
+
+  if (fleet_program_ != 0)
+  {
+    glDeleteProgram(fleet_program_);
+    fleet_program_ = 0;
+  }
+
+  if (grid_program_ != 0)
+  {
+    glDeleteProgram(grid_program_);
+    grid_program_ = 0;
+  }
+
+  if (track_program_ != 0)
+  {
+    glDeleteProgram(track_program_);
+    track_program_ = 0;
+  }
 }
 
 std::pair<std::string, std::string> Core::read_shader_file(const char *vertex_path, const char *fragment_path)
@@ -90,10 +150,9 @@ std::pair<std::string, std::string> Core::read_shader_file(const char *vertex_pa
   return {vertex_code, fragment_code};
 }
 
-void Core::init_program()
+GLuint Core::build_program(const char *vertex_path, const char *fragment_path)
 {
-  auto [vertex_code, fragment_code] = read_shader_file("/Users/mds/my/spatial_plane_simulation/glsl/vertex.glsl",
-                                                       "/Users/mds/my/spatial_plane_simulation/glsl/fragment.glsl");
+  auto [vertex_code, fragment_code] = read_shader_file(vertex_path, fragment_path);
   const char *v_shader_code = vertex_code.c_str();
   const char *f_shader_code = fragment_code.c_str();
 
@@ -127,15 +186,15 @@ void Core::init_program()
     assert(false && "Fragment Shader Compile Error");
   }
 
-  shader_program_ = glCreateProgram();
-  glAttachShader(shader_program_, vertex);
-  glAttachShader(shader_program_, fragment);
-  glLinkProgram(shader_program_);
+  GLuint program = glCreateProgram();
+  glAttachShader(program, vertex);
+  glAttachShader(program, fragment);
+  glLinkProgram(program);
 
-  glGetProgramiv(shader_program_, GL_LINK_STATUS, &success);
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
   if (!success)
   {
-    glGetProgramInfoLog(shader_program_, 512, NULL, infoLog);
+    glGetProgramInfoLog(program, 512, NULL, infoLog);
     std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
               << infoLog
               << std::endl;
@@ -144,72 +203,128 @@ void Core::init_program()
 
   glDeleteShader(vertex);
   glDeleteShader(fragment);
+
+  // 所有着色器共用同一个摄像机UBO
+  GLuint camera_block_index = glGetUniformBlockIndex(program, "Camera");
+  if (camera_block_index != GL_INVALID_INDEX)
+  {
+    glUniformBlockBinding(program, camera_block_index, kCameraBindingPoint);
+  }
+
+  return program;
+}
+
+void Core::init_program()
+{
+  shader_program_ = build_program(SHADER_DIR "vertex.glsl", SHADER_DIR "fragment.glsl");
+
+  // 缓存uniform位置，避免每次绘制都按字符串查找
+  model_loc_ = glGetUniformLocation(shader_program_, "model");
+  object_color_loc_ = glGetUniformLocation(shader_program_, "ObjectColor");
+
+  fleet_program_ = build_program(SHADER_DIR "fleet_vertex.glsl", SHADER_DIR "fleet_fragment.glsl");
+
+  grid_program_ = build_program(SHADER_DIR "grid_vertex.glsl", SHADER_DIR "grid_fragment.glsl");
+
+  track_program_ = build_program(SHADER_DIR "track_vertex.glsl", SHADER_DIR "track_fragment.glsl");
+  track_lane_width_loc_ = glGetUniformLocation(track_program_, "LaneWidth");
+  glUseProgram(track_program_);
+  glUniform1i(glGetUniformLocation(track_program_, "Centerline"), 0);
+  glUseProgram(0);
+}
+
+void Core::init_camera_UBO()
+{
+  // 每帧的观察矩阵、投影矩阵、两者乘积的逆以及渲染原点放在同一个UBO中，所有渲染流程共用
+  glGenBuffers(1, &camera_UBO_);
+  glBindBuffer(GL_UNIFORM_BUFFER, camera_UBO_);
+  glBufferData(GL_UNIFORM_BUFFER, 3 * sizeof(glm::mat4) + sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  glBindBufferBase(GL_UNIFORM_BUFFER, kCameraBindingPoint, camera_UBO_);
+}
+
+void Core::begin_frame(int width, int height)
+{
+  glm::vec3 render_position = simulation_.render_position();
+
+  // 渲染原点跟着摄像机走，离路径原点几十公里时送进 GPU 的也只是几十米内的坐标，不会抖动。
+  // 原点只在水平方向移动，地面仍是 y = 0；顶点数据保持路径坐标，原点移动时什么都不用重传
+  render_origin_ = glm::vec3(std::round(camera_position_.x / kRenderOriginCell) * kRenderOriginCell, 0.0f,
+                             std::round(camera_position_.z / kRenderOriginCell) * kRenderOriginCell);
+
+  if (follow_model_)
+  {
+    // 摄像机看向模型的位置
+    view_ = glm::lookAt(
+        camera_position_ - render_origin_,
+        render_position - render_origin_,
+        glm::vec3(0.0f, 1.0f, 0.0f));
+  }
+  else
+  {
+    view_ = glm::lookAt(
+        camera_position_ - render_origin_,
+        -render_origin_,             // 看向路径原点
+        glm::vec3(0.0f, 1.0f, 0.0f)  // 上方向
+    );
+  }
+
+  float aspect = height > 0 ? (float)width / (float)height : 1280.0f / 800.0f;
+  projection_ = glm::perspective(glm::radians(55.0f), aspect, near_plane_, far_plane_);
+  camera_eye_ = camera_position_;
+  const glm::mat4 view_projection = projection_ * view_;
+  const glm::mat4 inverse_view_projection = glm::inverse(view_projection);
+  // 剔除和细节层级在路径坐标中计算，视锥体带上原点的平移
+  frustum_.set(view_projection * glm::translate(glm::mat4(1.0f), -render_origin_));
+  viewport_height_ = std::max(height, 1);
+
+  // 每帧只上传一次，各渲染流程直接使用
+  glBindBuffer(GL_UNIFORM_BUFFER, camera_UBO_);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(view_));
+  glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(projection_));
+  glBufferSubData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(inverse_view_projection));
+  const glm::vec4 render_origin = glm::vec4(render_origin_, 0.0f);
+  glBufferSubData(GL_UNIFORM_BUFFER, 3 * sizeof(glm::mat4), sizeof(glm::vec4), glm::value_ptr(render_origin));
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  glBindBufferBase(GL_UNIFORM_BUFFER, kCameraBindingPoint, camera_UBO_);
 }
 
 void Core::init_core()
 {
   init_program();
+  init_camera_UBO();
   init_grid_VAO();
   init_cube_VAO();
+  init_fleet_VAO();
   init_path_VAO();
-  init_track_VAOs();
-  init_predefined_path();
+  glGenVertexArrays(1, &track_VAO_);
+
+  simulation_.init_predefined_path();
+  reset_track_chunks();
+  init_fleet();
 }
 
-unsigned int Core::build_grid_vertices(std::vector<float> &vertices, int grid_num)
+bool Core::load_path_file(const std::string &file_path)
 {
-  int area = grid_num / 2;
-  for (int i = -area; i <= area; i++)
-  {
-    vertices.push_back(-area);
-    vertices.push_back(0.0f);
-    vertices.push_back(i);
-    vertices.push_back(area);
-    vertices.push_back(0.0f);
-    vertices.push_back(i);
-  }
-  for (int i = -area; i <= area; ++i)
-  {
-    vertices.push_back(i);
-    vertices.push_back(0.0f);
-    vertices.push_back(-area);
-    vertices.push_back(i);
-    vertices.push_back(0.0f);
-    vertices.push_back(area);
-  }
-  return vertices.size();
+  // 旧的映射文件在加载成功后就会关闭，先让预取线程停下来
+  path_chunks_.clear();
+  if (!simulation_.load_path_file(file_path))
+  {
+    return false;
+  }
+
+  // 赛道边界和车队都依赖路径
+  reset_track_chunks();
+  init_fleet();
+  return true;
 }
 
 void Core::init_grid_VAO()
 {
-  // float vertices[] = {
-  //     0.5f, 0.5f, 0.0f,   // top right
-  //     0.5f, -0.5f, 0.0f,  // bottom right
-  //     -0.5f, -0.5f, 0.0f, // bottom left
-  //     -0.5f, 0.5f, 0.0f   // top left
-  // };
-
-  // unsigned int indices[] = {
-  //     0, 1, 2,
-  //     0, 2, 3};
-
-  std::vector<float> vertices;
-  grid_vertex_num_ = build_grid_vertices(vertices, 30);
-  grid_vertex_num_ = grid_vertex_num_ / 3;
-
-  GLuint VBO;
+  // 网格在着色器中按像素计算，全屏三角形的顶点由 gl_VertexID 生成，核心模式下仍需绑定一个空VAO
   glGenVertexArrays(1, &grid_VAO_);
-  glGenBuffers(1, &VBO);
-
-  glBindVertexArray(grid_VAO_);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-  glEnableVertexAttribArray(0);
-
-  glBindVertexArray(0);
-  glDeleteBuffers(1, &VBO);
 }
 
 void Core::init_cube_VAO()
@@ -269,40 +384,96 @@ void Core::init_cube_VAO()
 
   cub_vertex_num_ = 36;
 
-  GLuint VBO;
+  // 顶点缓冲保留下来，车队实例化渲染共用同一份网格
   glGenVertexArrays(1, &cube_VAO_);
-  glGenBuffers(1, &VBO);
+  glGenBuffers(1, &cube_VBO_);
 
   glBindVertexArray(cube_VAO_);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
+  glBindBuffer(GL_ARRAY_BUFFER, cube_VBO_);
   glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
   glEnableVertexAttribArray(0);
 
   glBindVertexArray(0);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Core::init_fleet_VAO()
+{
+  glGenVertexArrays(1, &fleet_VAO_);
+  glGenBuffers(1, &fleet_instance_VBO_);
+
+  glBindVertexArray(fleet_VAO_);
+
+  // 属性0：共用车身网格
+  glBindBuffer(GL_ARRAY_BUFFER, cube_VBO_);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
+  glEnableVertexAttribArray(0);
+
+  // 属性1、2：每个实例的位置+偏航角、颜色
+  glBindBuffer(GL_ARRAY_BUFFER, fleet_instance_VBO_);
+  glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(VehicleInstance), (void *)offsetof(VehicleInstance, position));
+  glEnableVertexAttribArray(1);
+  glVertexAttribDivisor(1, 1);
+  glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(VehicleInstance), (void *)offsetof(VehicleInstance, color));
+  glEnableVertexAttribArray(2);
+  glVertexAttribDivisor(2, 1);
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  fleet_instance_capacity_ = 0;
+  fleet_instance_count_ = 0;
+}
+
+void Core::update_fleet_instances(const std::vector<VehicleInstance> &instances)
+{
+  glBindBuffer(GL_ARRAY_BUFFER, fleet_instance_VBO_);
+
+  size_t count = instances.size();
+  if (count > fleet_instance_capacity_)
+  {
+    // 容量按2的幂增长，避免数量变化时频繁重新分配
+    size_t capacity = fleet_instance_capacity_ > 0 ? fleet_instance_capacity_ : 256;
+    while (capacity < count)
+    {
+      capacity *= 2;
+    }
+    fleet_instance_capacity_ = capacity;
+  }
 
-  glDeleteBuffers(1, &VBO);
+  // 先丢弃旧存储再写入，驱动可以换一块新内存而不必等待上一帧的绘制完成
+  glBufferData(GL_ARRAY_BUFFER, fleet_instance_capacity_ * sizeof(VehicleInstance), nullptr, GL_STREAM_DRAW);
+  if (count > 0)
+  {
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(VehicleInstance), instances.data());
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  fleet_instance_count_ = count;
 }
 
 void Core::init_path_VAO()
 {
-  // 初始化为空的VAO，后续通过update_path_VAO更新
+  // 轨迹顶点缓冲常驻，后续通过update_path_VAO只写入新增的点
   glGenVertexArrays(1, &path_VAO_);
   glBindVertexArray(path_VAO_);
 
-  GLuint VBO;
-  glGenBuffers(1, &VBO);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
+  glGenBuffers(1, &path_VBO_);
+  glBindBuffer(GL_ARRAY_BUFFER, path_VBO_);
 
   // 设置顶点属性
   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
   glEnableVertexAttribArray(0);
 
+  // 下标缓冲记录在VAO中
+  glGenBuffers(1, &path_EBO_);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, path_EBO_);
+
   glBindVertexArray(0);
-  glDeleteBuffers(1, &VBO);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-  path_vertex_num_ = 0;
+  path_VBO_capacity_ = 0;
 }
 
 void Core::render_cube()
@@ -310,110 +481,79 @@ void Core::render_cube()
   glUseProgram(shader_program_);
   glBindVertexArray(cube_VAO_);
 
-  GLuint grid_color = glGetUniformLocation(shader_program_, "ObjectColor");
-  glUniform3f(grid_color, 0.0f, 1.0f, 0.0f);
+  glUniform3f(object_color_loc_, 0.0f, 1.0f, 0.0f);
 
+  // 模型矩阵直接变换到渲染原点的相对坐标，平移量很小
   glm::mat4 model = glm::mat4(1.0f);
-
-  model = glm::translate(model, model_translate);
+  model = glm::translate(model, simulation_.render_position() - render_origin_);
 
   // 在跟随模式下，让模型的Y轴旋转跟随偏航角
   if (follow_model_)
   {
-    model = glm::rotate(model, glm::radians(yaw_angle_), glm::vec3(0.0f, 1.0f, 0.0f)); // 先应用偏航角
+    model = glm::rotate(model, glm::radians(simulation_.render_yaw_angle()), glm::vec3(0.0f, 1.0f, 0.0f)); // 先应用偏航角
   }
 
   model = glm::rotate(model, glm::radians(model_rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
   model = glm::rotate(model, glm::radians(model_rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
   model = glm::rotate(model, glm::radians(model_rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
 
-  glm::mat4 view;
-  if (follow_model_)
-  {
-    // 摄像机看向模型的位置
-    view = glm::lookAt(
-        camera_position_,
-        model_translate, // 看向模型位置，而不是原点
-        glm::vec3(0.0f, 1.0f, 0.0f));
-  }
-  else
-  {
-    view = glm::lookAt(
-        camera_position_,
-        glm::vec3(0.0f, 0.0f, 0.0f),
-        glm::vec3(0.0f, 1.0f, 0.0f));
-  }
-
-  glm::mat4 projection = glm::perspective(glm::radians(55.0f), 1280.0f / 800.0f, 0.1f, 100.0f);
-
-  GLuint transformLocModel = glGetUniformLocation(shader_program_, "model");
-  glUniformMatrix4fv(transformLocModel, 1, GL_FALSE, glm::value_ptr(model));
-
-  GLuint transformLocView = glGetUniformLocation(shader_program_, "view");
-  glUniformMatrix4fv(transformLocView, 1, GL_FALSE, glm::value_ptr(view));
-
-  GLuint transformLocProjection = glGetUniformLocation(shader_program_, "projection");
-  glUniformMatrix4fv(transformLocProjection, 1, GL_FALSE, glm::value_ptr(projection));
+  glUniformMatrix4fv(model_loc_, 1, GL_FALSE, glm::value_ptr(model));
 
   glDrawArrays(GL_TRIANGLES, 0, 36);
   glBindVertexArray(0);
 }
 
-void Core::render_grid()
+void Core::render_fleet()
 {
-  // 更新路径播放
-  if (is_playing_)
+  if (fleet_instance_count_ == 0)
   {
-    update_path_playback();
+    return;
   }
 
-  // 更新摄像机跟随
-  if (follow_model_)
-  {
-    update_camera_follow();
-  }
+  // 所有车辆一次实例化绘制
+  glUseProgram(fleet_program_);
+  glBindVertexArray(fleet_VAO_);
+  glDrawArraysInstanced(GL_TRIANGLES, 0, cub_vertex_num_, (GLsizei)fleet_instance_count_);
+  glBindVertexArray(0);
+}
 
-  glUseProgram(shader_program_);
+void Core::render_grid()
+{
+  // 无限地面网格：代价只与像素数有关，淡出的线需要混合
+  glUseProgram(grid_program_);
   glBindVertexArray(grid_VAO_);
 
-  GLuint grid_color = glGetUniformLocation(shader_program_, "ObjectColor");
-  glUniform3f(grid_color, 0.0f, 0.0f, 0.0f);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  glDisable(GL_BLEND);
 
-  glm::mat4 model = glm::mat4(1.0f);
+  glBindVertexArray(0);
+}
 
-  glm::mat4 view;
-  if (follow_model_)
+void Core::render_scene()
+{
+  // 没有深度测试，按先后顺序覆盖；每个渲染流程同时计 CPU 和 GPU 时间
   {
-    // 摄像机看向模型的位置
-    view = glm::lookAt(
-        camera_position_,
-        model_translate, // 看向模型位置
-        glm::vec3(0.0f, 1.0f, 0.0f));
+    ProfileScope scope(profiler_, "render_grid", true);
+    render_grid();
   }
-  else
   {
-    view = glm::lookAt(
-        camera_position_,
-        glm::vec3(0.0f, 0.0f, 0.0f), // 看向原点
-        glm::vec3(0.0f, 1.0f, 0.0f)  // 上方向
-    );
+    ProfileScope scope(profiler_, "render_track_boundaries", true);
+    render_track_boundaries(); // 先渲染赛道边界
+  }
+  {
+    ProfileScope scope(profiler_, "render_path", true);
+    render_path(); // 然后渲染中心线
+  }
+  {
+    ProfileScope scope(profiler_, "render_fleet", true);
+    render_fleet(); // 车队
+  }
+  {
+    ProfileScope scope(profiler_, "render_cube", true);
+    render_cube(); // 最后渲染车子
   }
-
-  glm::mat4 projection;
-  projection = glm::perspective(glm::radians(55.0f), 1280.0f / 800.0f, 0.1f, 100.0f);
-
-  GLuint transformLocModel = glGetUniformLocation(shader_program_, "model");
-  glUniformMatrix4fv(transformLocModel, 1, GL_FALSE, glm::value_ptr(model));
-
-  GLuint transformLocView = glGetUniformLocation(shader_program_, "view");
-  glUniformMatrix4fv(transformLocView, 1, GL_FALSE, glm::value_ptr(view));
-
-  GLuint transformLocProjection = glGetUniformLocation(shader_program_, "projection");
-  glUniformMatrix4fv(transformLocProjection, 1, GL_FALSE, glm::value_ptr(projection));
-
-  // glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-  glDrawArrays(GL_LINES, 0, grid_vertex_num_);
-  glBindVertexArray(0);
 }
 
 void Core::render_tool_panel()
@@ -435,42 +575,77 @@ void Core::render_tool_panel()
     ImGui::SliderFloat("相机高度", &camera_height_, 0.5f, 10.0f);
   }
 
+  // 远近平面相差多少倍都可以，场景没有深度测试，不受深度缓冲精度限制
+  float near_plane = near_plane_;
+  float far_plane = far_plane_;
+  bool clip_changed = ImGui::SliderFloat("近平面", &near_plane, 0.01f, 10.0f, "%.2f米", ImGuiSliderFlags_Logarithmic);
+  clip_changed |= ImGui::SliderFloat("远平面", &far_plane, 20.0f, 50000.0f, "%.0f米", ImGuiSliderFlags_Logarithmic);
+  if (clip_changed)
+  {
+    set_clip_planes(near_plane, far_plane);
+  }
+
   ImGui::SeparatorText("路径播放");
 
   // 播放控制按钮
-  if (!is_playing_)
+  if (!simulation_.is_playing())
   {
     if (ImGui::Button("播放路径"))
     {
-      start_path_playback();
+      simulation_.start_path_playback();
+    }
+    if (simulation_.play_time() > 0.0)
+    {
+      ImGui::SameLine();
+      if (ImGui::Button("继续播放"))
+      {
+        simulation_.resume_path_playback();
+      }
     }
   }
   else
   {
     if (ImGui::Button("停止播放"))
     {
-      stop_path_playback();
+      simulation_.stop_path_playback();
     }
   }
 
   ImGui::SameLine();
   if (ImGui::Button("重置路径"))
   {
-    reset_path_playback();
+    simulation_.reset_path_playback();
+    reset_fleet();
+  }
+
+  // 时间轴拖动，任意跳转
+  float play_time = (float)simulation_.play_time();
+  if (ImGui::SliderFloat("时间轴", &play_time, 0.0f, (float)simulation_.path_duration(), "%.2f秒"))
+  {
+    simulation_.seek(play_time);
   }
 
   // 播放设置
-  ImGui::SliderFloat("播放速度", &play_speed_, 0.1f, 5.0f);
-  ImGui::Checkbox("循环播放", &loop_play_);
+  float play_speed = (float)simulation_.play_speed();
+  if (ImGui::SliderFloat("播放速度", &play_speed, 0.1f, 5.0f))
+  {
+    simulation_.set_play_speed(play_speed);
+  }
+  bool loop_play = simulation_.loop_play();
+  if (ImGui::Checkbox("循环播放", &loop_play))
+  {
+    simulation_.set_loop_play(loop_play);
+  }
 
   // 播放状态显示
-  if (is_playing_)
+  if (simulation_.is_playing())
   {
-    float current_time = (ImGui::GetTime() - play_start_time_) * play_speed_;
     ImGui::Text("播放状态: 进行中");
-    ImGui::Text("当前时间: %.2f秒", current_time);
-    ImGui::Text("路径点: %d/%zu", current_path_index_, predefined_path_.size());
-    ImGui::Text("当前朝向: %.1f°", yaw_angle_);
+    ImGui::Text("当前时间: %.2f秒", simulation_.play_time());
+    ImGui::Text("路径点: %d/%zu", simulation_.current_path_index(), simulation_.path().size());
+    ImGui::Text("当前朝向: %.1f°", simulation_.yaw_angle());
+    const glm::dvec3 world_position = simulation_.path_origin() + glm::dvec3(simulation_.position());
+    ImGui::Text("世界坐标: %.3f, %.3f, %.3f", world_position.x, world_position.y, world_position.z);
   }
   else
   {
@@ -479,32 +654,50 @@ void Core::render_tool_panel()
 
   // 路径显示控制
   ImGui::Checkbox("显示中心线", &show_path_);
-  ImGui::Checkbox("显示赛道边界", &show_track_boundaries_);
+  ImGui::Checkbox("显示赛道", &show_track_boundaries_);
 
-  if (ImGui::SliderFloat("赛道宽度", &track_lane_width_, 0.5f, 3.0f))
+  // 宽度只是着色器的 uniform，拖动时不需要重新生成边界
+  ImGui::SliderFloat("赛道宽度", &track_lane_width_, 0.5f, 3.0f);
+  ImGui::SliderFloat("细节误差（像素）", &lod_error_pixels_, 0.25f, 8.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+  ImGui::Text("绘制点数: 路面 %zu, 轨迹 %zu", track_drawn_points_, trail_drawn_points_);
+  ImGui::Text("路面分块: 绘制 %zu, 剔除 %zu", track_chunks_drawn_, track_chunks_culled_);
+  ImGui::Text("轨迹块: 绘制 %zu, 剔除 %zu", trail_blocks_drawn_, trail_blocks_culled_);
+  ImGui::Text("常驻路径分块: %zu/%zu", path_chunks_.resident_count(), path_chunks_.chunk_count());
+
+  if (ImGui::Button("清空轨迹"))
   {
-    // 当赛道宽度改变时，重新生成边界
-    generate_track_boundaries();
+    simulation_.clear_traveled_path();
   }
 
-  if (ImGui::Button("清空轨迹"))
+  ImGui::Text("预定义路径点: %zu", simulation_.path().size());
+  int trail_capacity = (int)simulation_.traveled_path().capacity();
+  if (ImGui::SliderInt("轨迹容量", &trail_capacity, 1000, 1000000, "%d", ImGuiSliderFlags_Logarithmic))
   {
-    clear_traveled_path();
+    simulation_.set_trail_capacity((size_t)trail_capacity);
   }
+  ImGui::Text("轨迹点数: %zu/%zu", simulation_.traveled_path().size(), simulation_.traveled_path().capacity());
 
-  ImGui::Text("预定义路径点: %zu", predefined_path_.size());
-  ImGui::Text("轨迹点数: %zu", traveled_path_.size());
+  ImGui::SeparatorText("车队");
+  if (ImGui::SliderInt("车队数量", &fleet_size_, 0, 100000, "%d", ImGuiSliderFlags_Logarithmic))
+  {
+    init_fleet();
+  }
+  ImGui::Text("并行线程: %zu", task_pool_.concurrency());
 
   ImGui::SeparatorText("模型控制");
 
   // 只在非播放状态下显示手动控制
-  if (!is_playing_)
+  if (!simulation_.is_playing())
   {
     if (!follow_model_)
     {
       // 非跟随模式下显示完整的旋转控制
       ImGui::DragFloat3("模型旋转", glm::value_ptr(model_rotation), 1.0f, -180.0f, 180.0f);
-      ImGui::DragFloat3("模型移动", glm::value_ptr(model_translate), 0.01f, -15.0f, 15.0f);
+      glm::vec3 model_translate = simulation_.position();
+      if (ImGui::DragFloat3("模型移动", glm::value_ptr(model_translate), 0.01f, -15.0f, 15.0f))
+      {
+        simulation_.set_position(model_translate);
+      }
     }
     else
     {
@@ -513,34 +706,28 @@ void Core::render_tool_panel()
       ImGui::DragFloat("模型Z轴旋转", &model_rotation.z, 1.0f, -180.0f, 180.0f);
 
       // 跟随模式下用偏航角控制移动方向和朝向
-      ImGui::SliderFloat("偏航角 (车头朝向)", &yaw_angle_, -180.0f, 180.0f);
+      float yaw_angle = simulation_.yaw_angle();
+      if (ImGui::SliderFloat("偏航角 (车头朝向)", &yaw_angle, -180.0f, 180.0f))
+      {
+        simulation_.set_yaw_angle(yaw_angle);
+      }
       if (ImGui::Button("前进"))
       {
-        float yaw_rad = glm::radians(yaw_angle_);
-        model_translate.x += 0.1f * sin(yaw_rad);
-        model_translate.z += 0.1f * cos(yaw_rad);
-        update_traveled_path(); // 手动移动时也记录轨迹
+        simulation_.move_forward(0.1f);
       }
       ImGui::SameLine();
       if (ImGui::Button("后退"))
       {
-        float yaw_rad = glm::radians(yaw_angle_);
-        model_translate.x -= 0.1f * sin(yaw_rad);
-        model_translate.z -= 0.1f * cos(yaw_rad);
-        update_traveled_path(); // 手动移动时也记录轨迹
+        simulation_.move_forward(-0.1f);
       }
       if (ImGui::Button("左转"))
       {
-        yaw_angle_ -= 5.0f;
-        if (yaw_angle_ < -180.0f)
-          yaw_angle_ = 180.0f;
+        simulation_.turn(-5.0f);
       }
       ImGui::SameLine();
       if (ImGui::Button("右转"))
       {
-        yaw_angle_ += 5.0f;
-        if (yaw_angle_ > 180.0f)
-          yaw_angle_ = -180.0f;
+        simulation_.turn(5.0f);
       }
     }
   }
@@ -552,550 +739,577 @@ void Core::render_tool_panel()
   ImGui::End();
 }
 
-void Core::update_camera_follow()
+void Core::update(double dt)
 {
-  // 汽车导航式跟随：摄像机在模型后方，跟随模型的朝向
-  float yaw_radians = glm::radians(yaw_angle_);
-
-  // 计算模型的后方位置（相对于模型朝向）
-  glm::vec3 backward_direction;
-  backward_direction.x = -sin(yaw_radians); // 模型后方的 x 方向
-  backward_direction.y = 0.0f;
-  backward_direction.z = -cos(yaw_radians); // 模型后方的 z 方向
-
-  // 摄像机位置 = 模型位置 + 后方偏移 + 高度偏移
-  camera_position_ = model_translate + backward_direction * camera_distance_;
-  camera_position_.y = model_translate.y + camera_height_;
-}
+  // 按固定步长推进仿真，一帧内可能执行多步
+  int steps = 0;
+  {
+    ProfileScope scope(profiler_, "simulation_advance");
+    steps = simulation_.advance(dt);
+  }
 
-void Core::init_predefined_path()
-{
-  // 创建一个简单的圆形赛道，确保在网格范围内（-15到15）
-  predefined_path_.clear();
+  // 先取走上一帧提交的车队推进结果，再提交本帧的推进，渲染期间由工作线程并行计算
+  // 车队因此比主车辆晚一帧显示；车队状态只由时间决定，本帧的多步合并为一次推进
+  {
+    ProfileScope scope(profiler_, "finish_fleet_update");
+    finish_fleet_update();
+  }
+  if (simulation_.is_playing() && steps > 0 && fleet_.size() > 0)
+  {
+    submit_fleet_update(steps / (double)simulation_.step_rate() * simulation_.play_speed());
+  }
 
-  const int total_points = 1000;
-  const float total_time = 120.0f; // 总时长120秒
-  const float time_step = total_time / total_points;
+  // 更新摄像机跟随
+  if (follow_model_)
+  {
+    update_camera_follow();
+  }
 
-  // 圆形赛道参数
-  const float radius = 10.0f; // 半径10，确保在网格范围内
+  // 车队实例数据每帧上传
+  {
+    ProfileScope scope(profiler_, "update_fleet_instances");
+    pack_fleet_instances();
+    update_fleet_instances(fleet_instances_);
+  }
 
-  for (int i = 0; i < total_points; i++)
+  // 赛道边界只保留播放位置附近的分块
   {
-    float t = (float)i / (total_points - 1); // 0.0 到 1.0
-    float time = i * time_step;
+    ProfileScope scope(profiler_, "update_track_chunks");
+    update_track_chunks();
+  }
 
-    // 圆形的参数方程
-    float angle = t * 2.0f * M_PI; // 完整的一圈，从0到2π
+  // 轨迹有变化时才更新路径VAO，每帧最多一次
+  if (path_VBO_generation_ != simulation_.traveled_path_generation() ||
+      path_VBO_pushed_ != simulation_.traveled_path().push_count())
+  {
+    ProfileScope scope(profiler_, "update_path_VAO");
+    update_path_VAO();
+  }
+}
 
-    glm::vec3 position;
-    position.x = radius * cos(angle);
-    position.z = radius * sin(angle);
-    position.y = 0.0f;
+void Core::init_fleet()
+{
+  finish_fleet_update();
+  fleet_.set_path(simulation_.path());
+  fleet_.populate((size_t)fleet_size_);
 
-    predefined_path_.push_back({position, 0.0f, time});
+  fleet_colors_.resize(fleet_.size());
+  for (size_t i = 0; i < fleet_colors_.size(); i++)
+  {
+    ImGui::ColorConvertHSVtoRGB(fmodf(i * 0.618034f, 1.0f), 0.7f, 0.9f, fleet_colors_[i].x, fleet_colors_[i].y, fleet_colors_[i].z);
   }
 
-  // 自动计算每个路径点的正确朝向
-  calculate_path_orientations();
+  // 立即生成快照，车队数量变化的这一帧就能正确绘制
+  submit_fleet_update(0.0);
+  finish_fleet_update();
+}
 
-  // 生成赛道边界
-  generate_track_boundaries();
+void Core::set_clip_planes(float near_plane, float far_plane)
+{
+  near_plane_ = std::max(near_plane, 0.001f);
+  far_plane_ = std::max(far_plane, near_plane_ * 2.0f);
 }
 
-void Core::start_path_playback()
+void Core::set_fleet_size(int fleet_size)
 {
-  if (!predefined_path_.empty())
-  {
-    is_playing_ = true;
-    play_start_time_ = ImGui::GetTime();
-    current_path_index_ = 0;
+  fleet_size_ = std::max(fleet_size, 0);
+  init_fleet();
+}
 
-    // 设置初始位置
-    model_translate = predefined_path_[0].position;
-    yaw_angle_ = predefined_path_[0].yaw;
-  }
+void Core::reset_fleet()
+{
+  finish_fleet_update();
+  fleet_.reset();
+  submit_fleet_update(0.0);
+  finish_fleet_update();
 }
 
-void Core::stop_path_playback()
+void Core::submit_fleet_update(double dt)
 {
-  is_playing_ = false;
+  FleetSnapshot *back_snapshot = &fleet_snapshots_[1 - fleet_front_snapshot_];
+  task_pool_.run(fleet_job_, [this, dt, back_snapshot]() { fleet_.step(dt, task_pool_, back_snapshot); });
+  fleet_job_pending_ = true;
 }
 
-void Core::reset_path_playback()
+void Core::finish_fleet_update()
 {
-  is_playing_ = false;
-  current_path_index_ = 0;
-  clear_traveled_path(); // 重置时清空轨迹
-  if (!predefined_path_.empty())
+  if (!fleet_job_pending_)
   {
-    model_translate = predefined_path_[0].position;
-    yaw_angle_ = predefined_path_[0].yaw;
+    return;
   }
+
+  task_pool_.wait(fleet_job_);
+  fleet_front_snapshot_ = 1 - fleet_front_snapshot_;
+  fleet_job_pending_ = false;
 }
 
-void Core::update_path_playback()
+void Core::pack_fleet_instances()
 {
-  if (!is_playing_ || predefined_path_.empty())
+  const FleetSnapshot &snapshot = fleet_snapshots_[fleet_front_snapshot_];
+  const size_t count = std::min(snapshot.size(), fleet_colors_.size());
+  const std::vector<float> &position_x = snapshot.position_x;
+  const std::vector<float> &position_y = snapshot.position_y;
+  const std::vector<float> &position_z = snapshot.position_z;
+  const std::vector<float> &yaws = snapshot.yaws;
+
+  fleet_instances_.resize(count);
+  for (size_t i = 0; i < count; i++)
   {
-    return;
+    VehicleInstance &instance = fleet_instances_[i];
+    instance.position = glm::vec3(position_x[i], position_y[i], position_z[i]);
+    instance.yaw = yaws[i];
+    instance.color = fleet_colors_[i];
   }
+}
+
+void Core::update_camera_follow()
+{
+  // 汽车导航式跟随：摄像机在模型后方，跟随模型的朝向
+  glm::vec3 model_translate = simulation_.render_position();
+  float yaw_radians = glm::radians(simulation_.render_yaw_angle());
+
+  // 计算模型的后方位置（相对于模型朝向）
+  glm::vec3 backward_direction;
+  backward_direction.x = -sin(yaw_radians); // 模型后方的 x 方向
+  backward_direction.y = 0.0f;
+  backward_direction.z = -cos(yaw_radians); // 模型后方的 z 方向
 
-  float current_time = (ImGui::GetTime() - play_start_time_) * play_speed_;
+  // 摄像机位置 = 模型位置 + 后方偏移 + 高度偏移
+  camera_position_ = model_translate + backward_direction * camera_distance_;
+  camera_position_.y = model_translate.y + camera_height_;
+}
 
-  // 找到当前时间对应的路径段
-  while (current_path_index_ < predefined_path_.size() - 1 &&
-         current_time > predefined_path_[current_path_index_ + 1].timestamp)
+void Core::upload_path_samples(size_t first, size_t count)
+{
+  const RingBuffer<glm::vec3> &traveled_path = simulation_.traveled_path();
+  const size_t capacity = traveled_path.capacity();
+
+  // 逻辑区间在物理存储中最多分成两段
+  while (count > 0)
   {
-    current_path_index_++;
+    size_t slot = traveled_path.physical_index(first);
+    size_t run = std::min(count, capacity - slot);
+    glBufferSubData(GL_ARRAY_BUFFER, slot * sizeof(glm::vec3), run * sizeof(glm::vec3), traveled_path.data() + slot);
+    refresh_trail_blocks(slot, run);
+
+    first += run;
+    count -= run;
   }
+}
 
-  // 检查是否到达路径末尾
-  if (current_path_index_ >= predefined_path_.size() - 1)
+void Core::refresh_trail_blocks(size_t first_slot, size_t count)
+{
+  const RingBuffer<glm::vec3> &traveled_path = simulation_.traveled_path();
+  const size_t capacity = traveled_path.capacity();
+  const glm::vec3 *samples = traveled_path.data();
+
+  for (size_t block_index = first_slot / kTrailBlockSize; block_index * kTrailBlockSize < first_slot + count; block_index++)
   {
-    if (loop_play_)
-    {
-      // 循环播放，重新开始
-      reset_path_playback();
-      start_path_playback();
-      return;
-    }
-    else
+    TrailBlock &block = trail_blocks_[block_index];
+    block.bounds_min = glm::vec3(1e30f);
+    block.bounds_max = glm::vec3(-1e30f);
+    block.sample_count = 0;
+
+    float length = 0.0f;
+    const size_t end = std::min((block_index + 1) * kTrailBlockSize, capacity);
+    for (size_t slot = block_index * kTrailBlockSize; slot < end; slot++)
     {
-      // 停止播放
-      stop_path_playback();
-      return;
+      // 只统计当前有效的槽位；最新点与最旧点物理相邻但逻辑上不相连
+      size_t logical = slot >= traveled_path.head() ? slot - traveled_path.head() : slot + capacity - traveled_path.head();
+      if (logical >= traveled_path.size())
+        continue;
+
+      block.bounds_min = glm::min(block.bounds_min, samples[slot]);
+      block.bounds_max = glm::max(block.bounds_max, samples[slot]);
+      if (block.sample_count > 0 && logical > 0)
+        length += glm::length(samples[slot] - samples[slot - 1]);
+      block.sample_count++;
     }
+    block.spacing = block.sample_count > 1 ? length / (block.sample_count - 1) : 0.0f;
   }
+}
 
-  // 在当前路径段内进行插值
-  const PathPoint &current_point = predefined_path_[current_path_index_];
-  const PathPoint &next_point = predefined_path_[current_path_index_ + 1];
-
-  float segment_duration = next_point.timestamp - current_point.timestamp;
-  float segment_progress = (current_time - current_point.timestamp) / segment_duration;
-  segment_progress = glm::clamp(segment_progress, 0.0f, 1.0f);
+void Core::update_path_VAO()
+{
+  const RingBuffer<glm::vec3> &traveled_path = simulation_.traveled_path();
+  const size_t capacity = traveled_path.capacity();
+  const size_t size = traveled_path.size();
 
-  // 插值计算当前位置和朝向
-  model_translate = interpolate_position(current_point, next_point, segment_progress);
+  glBindBuffer(GL_ARRAY_BUFFER, path_VBO_);
 
-  // 改进：使用更平滑的朝向计算
-  glm::vec3 current_direction = next_point.position - current_point.position;
+  if (path_VBO_capacity_ != capacity)
+  {
+    // 容量变化时重新分配
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::vec3), nullptr, GL_DYNAMIC_DRAW);
+    path_VBO_capacity_ = capacity;
+    path_VBO_generation_ = ~0u;
+    trail_blocks_.assign((capacity + kTrailBlockSize - 1) / kTrailBlockSize, TrailBlock());
+  }
 
-  // 计算目标朝向，考虑前瞻性转向
-  float target_yaw;
-  if (current_path_index_ + 2 < predefined_path_.size())
+  unsigned long long new_samples = traveled_path.push_count() - path_VBO_pushed_;
+  if (path_VBO_generation_ != simulation_.traveled_path_generation() || new_samples >= size)
+  {
+    // 轨迹被清空或重排，整体重传当前有效的点
+    std::fill(trail_blocks_.begin(), trail_blocks_.end(), TrailBlock());
+    upload_path_samples(0, size);
+  }
+  else
   {
-    const PathPoint &next_next_point = predefined_path_[current_path_index_ + 2];
-    glm::vec3 future_direction = next_next_point.position - next_point.position;
+    // 只上传新增的点，代价与新增点数成正比
+    upload_path_samples(size - (size_t)new_samples, (size_t)new_samples);
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    // 使用更平滑的前瞻混合
-    float lookahead_factor = glm::smoothstep(0.3f, 1.0f, segment_progress);
-    glm::vec3 blended_direction = glm::mix(current_direction, future_direction, lookahead_factor * 0.3f);
+  path_VBO_generation_ = simulation_.traveled_path_generation();
+  path_VBO_pushed_ = traveled_path.push_count();
+}
 
-    if (glm::length(blended_direction) > 0.001f)
+float Core::projected_scale(const glm::vec3 &bounds_min, const glm::vec3 &bounds_max) const
+{
+  // 透视投影下距离 d 处一米对应 projection[1][1] * 视口高度 / 2 / d 个像素，取包围盒最近点的距离
+  float distance = glm::length(glm::clamp(camera_eye_, bounds_min, bounds_max) - camera_eye_);
+  return projection_[1][1] * 0.5f * (float)viewport_height_ / std::max(distance, 1e-3f);
+}
+
+size_t Core::classify_trail_blocks()
+{
+  const RingBuffer<glm::vec3> &traveled_path = simulation_.traveled_path();
+  const size_t capacity = traveled_path.capacity();
+  const size_t head = traveled_path.head();
+
+  // 每块先做视锥体剔除，再定步长：抽样后相邻点在屏幕上的距离不超过允许误差
+  trail_blocks_drawn_ = 0;
+  trail_blocks_culled_ = 0;
+  size_t first_changed = SIZE_MAX;
+  const glm::vec3 lift = glm::vec3(0.0f, 0.01f, 0.0f); // 与绘制时的抬高一致
+  for (size_t block_index = 0; block_index < trail_blocks_.size(); block_index++)
+  {
+    TrailBlock &block = trail_blocks_[block_index];
+    if (block.sample_count == 0)
     {
-      target_yaw = glm::degrees(atan2(blended_direction.x, blended_direction.z));
+      block.stride = 1;
+      continue;
     }
-    else
+
+    const bool was_visible = block.visible;
+    const unsigned int old_stride = block.stride;
+    block.stride = 1;
+    block.visible = frustum_.intersects(block.bounds_min, block.bounds_max + lift);
+    if (!block.visible)
     {
-      target_yaw = yaw_angle_; // 保持当前朝向
+      trail_blocks_culled_++;
     }
-  }
-  else
-  {
-    // 使用当前移动方向
-    if (glm::length(current_direction) > 0.001f)
+    else
     {
-      target_yaw = glm::degrees(atan2(current_direction.x, current_direction.z));
+      trail_blocks_drawn_++;
+      if (block.sample_count >= 2)
+      {
+        float spacing_pixels = block.spacing * projected_scale(block.bounds_min, block.bounds_max);
+        while (block.stride < kTrailBlockSize && spacing_pixels * (block.stride * 2) <= lod_error_pixels_)
+          block.stride *= 2;
+      }
     }
-    else
+    if (block.visible != was_visible || block.stride != old_stride)
     {
-      target_yaw = yaw_angle_;
+      // 块内最旧的点：块跨过环形缓冲区的头部时就是头部，否则是块的第一个槽位
+      const size_t begin = block_index * kTrailBlockSize;
+      const size_t end = std::min(begin + kTrailBlockSize, capacity);
+      const size_t oldest = head >= begin && head < end ? 0 : begin >= head ? begin - head : begin + capacity - head;
+      first_changed = std::min(first_changed, oldest);
     }
   }
+  return first_changed;
+}
 
-  // 使用更平滑的插值到目标朝向，动态调整插值速度
-  float turn_speed = 0.08f; // 基础转向速度
-  float angle_diff = abs(interpolate_yaw(yaw_angle_, target_yaw, 1.0f) - yaw_angle_);
-
-  // 如果角度差异很大，稍微加快转向速度
-  if (angle_diff > 45.0f)
+size_t Core::trail_step(unsigned long long id, GLuint *entries, unsigned long long &next) const
+{
+  const RingBuffer<glm::vec3> &traveled_path = simulation_.traveled_path();
+  const unsigned long long first_id = traveled_path.push_count() - traveled_path.size();
+  const unsigned long long last_id = traveled_path.push_count() - 1;
+  const size_t slot = traveled_path.physical_index((size_t)(id - first_id));
+  entries[0] = (GLuint)slot;
+  if (id == last_id)
   {
-    turn_speed = 0.12f;
+    next = last_id + 1;
+    return 1;
   }
-  else if (angle_diff < 10.0f)
+
+  const TrailBlock &block = trail_blocks_[slot / kTrailBlockSize];
+  if (!block.visible)
   {
-    turn_speed = 0.05f; // 小角度时更平滑
+    // 剔除的块只保留首尾两点，中间断开线带；进出该块的两段仍然画出，由裁剪截到屏幕边缘
+    size_t block_end = std::min((slot / kTrailBlockSize + 1) * kTrailBlockSize, traveled_path.capacity());
+    unsigned long long last = std::min(id + (block_end - 1 - slot), last_id);
+    next = last == last_id ? last_id + 1 : last + 1;
+    if (last == id)
+    {
+      return 1;
+    }
+    entries[1] = kPrimitiveRestartIndex;
+    entries[2] = (GLuint)traveled_path.physical_index((size_t)(last - first_id));
+    return 3;
   }
 
-  yaw_angle_ = interpolate_yaw(yaw_angle_, target_yaw, turn_speed);
+  // 抽样点按全局序号对齐到步长，轨迹前移时已选中的点保持不变，不会闪烁；最新的点总是保留
+  next = std::min(id + (block.stride - id % block.stride), last_id);
+  return 1;
+}
 
-  // 更新轨迹记录
-  update_traveled_path();
+void Core::walk_trail(unsigned long long id)
+{
+  const unsigned long long end_id = simulation_.traveled_path().push_count();
+  while (id < end_id)
+  {
+    GLuint entries[3];
+    unsigned long long next = 0;
+    size_t count = trail_step(id, entries, next);
+    trail_steps_.push_back(TrailStep{trail_indices_.size(), id});
+    trail_indices_.insert(trail_indices_.end(), entries, entries + count);
+    id = next;
+  }
 }
 
-glm::vec3 Core::interpolate_position(const PathPoint &p1, const PathPoint &p2, float t)
+void Core::rebuild_trail_indices()
 {
-  // 使用平滑的Hermite插值（可以使用线性插值：mix）
-  return glm::mix(p1.position, p2.position, t);
+  const RingBuffer<glm::vec3> &traveled_path = simulation_.traveled_path();
+  trail_indices_.clear();
+  trail_steps_.clear();
+  trail_index_first_ = 0;
+  walk_trail(traveled_path.push_count() - traveled_path.size());
+
+  // 留出一倍的余量，之后新增的下标接在后面，用完时再整体重建。重新分配让驱动不必等待上一帧的绘制
+  const size_t count = trail_indices_.size();
+  if (count * 2 > trail_EBO_capacity_ || count * 8 < trail_EBO_capacity_)
+  {
+    trail_EBO_capacity_ = std::max<size_t>(count * 2, kTrailBlockSize);
+  }
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, trail_EBO_capacity_ * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+  glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, count * sizeof(GLuint), trail_indices_.data());
 }
 
-float Core::interpolate_yaw(float yaw1, float yaw2, float t)
+bool Core::patch_trail_indices(size_t first_changed)
 {
-  // 处理角度插值，考虑360度环绕
-  float diff = yaw2 - yaw1;
+  const RingBuffer<glm::vec3> &traveled_path = simulation_.traveled_path();
+  if (trail_steps_.size() < 2)
+  {
+    return false;
+  }
 
-  // 选择最短路径
-  if (diff > 180.0f)
+  // 最后一步可能被当时的终点截断，从倒数第二步开始重新抽样；有块改变时从落在该块及之后的第一步开始
+  size_t resume = trail_steps_.size() - 2;
+  if (first_changed != SIZE_MAX)
   {
-    diff -= 360.0f;
+    const unsigned long long changed_id = traveled_path.push_count() - traveled_path.size() + first_changed;
+    auto it = std::lower_bound(trail_steps_.begin(), trail_steps_.end(), changed_id,
+                               [](const TrailStep &step, unsigned long long id) { return step.id < id; });
+    resume = std::min(resume, (size_t)(it - trail_steps_.begin()));
   }
-  else if (diff < -180.0f)
+  const TrailStep resume_step = trail_steps_[resume];
+
+  // 最旧一端：从新的最旧点开始抽样，直到落在保留的某一步上，之后的抽样与原来完全相同
+  std::vector<GLuint> prefix;
+  std::vector<TrailStep> prefix_steps;
+  size_t merge = 0;
+  unsigned long long id = traveled_path.push_count() - traveled_path.size();
+  while (true)
   {
-    diff += 360.0f;
+    while (merge <= resume && trail_steps_[merge].id < id)
+      merge++;
+    if (merge > resume)
+      return false;
+    if (trail_steps_[merge].id == id)
+      break;
+
+    GLuint entries[3];
+    unsigned long long next = 0;
+    size_t count = trail_step(id, entries, next);
+    prefix_steps.push_back(TrailStep{prefix.size(), id});
+    prefix.insert(prefix.end(), entries, entries + count);
+    id = next;
   }
 
-  float result = yaw1 + diff * t;
-
-  // 保持在[-180, 180]范围内
-  while (result > 180.0f)
-    result -= 360.0f;
-  while (result < -180.0f)
-    result += 360.0f;
-
-  return result;
-}
-
-void Core::update_traveled_path()
-{
-  // 记录当前位置到轨迹中，使用更小的距离阈值来获得更详细的轨迹
-  if (traveled_path_.empty() ||
-      glm::distance(traveled_path_.back(), model_translate) > 0.05f)
+  // 新的开头写在重合处之前，原来的开头不再绘制
+  const size_t merge_offset = trail_steps_[merge].offset;
+  if (prefix.size() > merge_offset)
   {
-    traveled_path_.push_back(model_translate);
+    return false;
+  }
+  const size_t first = merge_offset - prefix.size();
+  std::copy(prefix.begin(), prefix.end(), trail_indices_.begin() + first);
 
-    // 增加轨迹点数量限制，因为现在我们有更多的路径点
-    if (traveled_path_.size() > 2000)
-    {
-      traveled_path_.erase(traveled_path_.begin());
-    }
+  trail_steps_.erase(trail_steps_.begin() + resume, trail_steps_.end());
+  trail_steps_.erase(trail_steps_.begin(), trail_steps_.begin() + merge);
+  for (auto it = prefix_steps.rbegin(); it != prefix_steps.rend(); ++it)
+  {
+    trail_steps_.push_front(TrailStep{first + it->offset, it->id});
+  }
 
-    // 更新路径VAO
-    update_path_VAO();
+  // 最新一端：从倒数第二步接着抽样，超出缓冲余量时整体重建
+  trail_indices_.resize(resume_step.offset);
+  walk_trail(resume_step.id);
+  if (trail_indices_.size() > trail_EBO_capacity_)
+  {
+    return false;
   }
-}
+  trail_index_first_ = first;
 
-void Core::clear_traveled_path()
-{
-  traveled_path_.clear();
-  update_path_VAO();
+  if (!prefix.empty())
+  {
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, first * sizeof(GLuint), prefix.size() * sizeof(GLuint), prefix.data());
+  }
+  glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, resume_step.offset * sizeof(GLuint),
+                  (trail_indices_.size() - resume_step.offset) * sizeof(GLuint), trail_indices_.data() + resume_step.offset);
+  return true;
 }
 
-void Core::update_path_VAO()
+void Core::update_trail_indices()
 {
-  if (traveled_path_.size() < 2)
+  const RingBuffer<glm::vec3> &traveled_path = simulation_.traveled_path();
+  const size_t first_changed = classify_trail_blocks();
+  const bool reset = trail_indices_generation_ != simulation_.traveled_path_generation();
+  if (first_changed == SIZE_MAX && !reset && trail_indices_pushed_ == traveled_path.push_count())
   {
-    path_vertex_num_ = 0;
     return;
   }
 
-  // 准备顶点数据：为每条线段创建两个顶点
-  std::vector<float> vertices;
-  for (size_t i = 0; i < traveled_path_.size() - 1; i++)
+  // 下标缓冲记录在VAO中，写入前先绑定
+  glBindVertexArray(path_VAO_);
+  if (reset || !patch_trail_indices(first_changed))
   {
-    // 线段起点
-    vertices.push_back(traveled_path_[i].x);
-    vertices.push_back(traveled_path_[i].y + 0.01f); // 稍微抬高避免与地面重叠
-    vertices.push_back(traveled_path_[i].z);
-
-    // 线段终点
-    vertices.push_back(traveled_path_[i + 1].x);
-    vertices.push_back(traveled_path_[i + 1].y + 0.01f);
-    vertices.push_back(traveled_path_[i + 1].z);
+    rebuild_trail_indices();
   }
-
-  path_vertex_num_ = vertices.size() / 3;
-
-  // 更新VAO
-  glBindVertexArray(path_VAO_);
-
-  GLuint VBO;
-  glGenBuffers(1, &VBO);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_DYNAMIC_DRAW);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-  glEnableVertexAttribArray(0);
-
   glBindVertexArray(0);
-  glDeleteBuffers(1, &VBO);
+
+  trail_indices_generation_ = simulation_.traveled_path_generation();
+  trail_indices_pushed_ = traveled_path.push_count();
 }
 
 void Core::render_path()
 {
-  if (!show_path_ || path_vertex_num_ == 0)
+  trail_drawn_points_ = 0;
+  if (!show_path_ || simulation_.traveled_path().size() < 2)
   {
     return;
   }
 
-  glUseProgram(shader_program_);
-  glBindVertexArray(path_VAO_);
-
-  GLuint path_color = glGetUniformLocation(shader_program_, "ObjectColor");
-  glUniform3f(path_color, 1.0f, 0.3f, 0.0f); // 橙色中心线（更明显）
-
-  glm::mat4 model = glm::mat4(1.0f);
-
-  glm::mat4 view;
-  if (follow_model_)
   {
-    view = glm::lookAt(
-        camera_position_,
-        model_translate,
-        glm::vec3(0.0f, 1.0f, 0.0f));
+    ProfileScope scope(profiler_, "update_trail_indices");
+    update_trail_indices();
   }
-  else
-  {
-    view = glm::lookAt(
-        camera_position_,
-        glm::vec3(0.0f, 0.0f, 0.0f),
-        glm::vec3(0.0f, 1.0f, 0.0f));
-  }
-
-  glm::mat4 projection = glm::perspective(glm::radians(55.0f), 1280.0f / 800.0f, 0.1f, 100.0f);
+  const size_t index_count = trail_indices_.size() - trail_index_first_;
+  trail_drawn_points_ = index_count;
 
-  GLuint transformLocModel = glGetUniformLocation(shader_program_, "model");
-  glUniformMatrix4fv(transformLocModel, 1, GL_FALSE, glm::value_ptr(model));
+  glUseProgram(shader_program_);
+  glBindVertexArray(path_VAO_);
 
-  GLuint transformLocView = glGetUniformLocation(shader_program_, "view");
-  glUniformMatrix4fv(transformLocView, 1, GL_FALSE, glm::value_ptr(view));
+  glUniform3f(object_color_loc_, 1.0f, 0.3f, 0.0f); // 橙色中心线（更明显）
 
-  GLuint transformLocProjection = glGetUniformLocation(shader_program_, "projection");
-  glUniformMatrix4fv(transformLocProjection, 1, GL_FALSE, glm::value_ptr(projection));
+  glm::mat4 model = glm::mat4(1.0f);
+  model = glm::translate(model, glm::vec3(0.0f, 0.01f, 0.0f) - render_origin_); // 稍微抬高避免与地面重叠
+  glUniformMatrix4fv(model_loc_, 1, GL_FALSE, glm::value_ptr(model));
 
   // 设置线宽（增加中心线粗细）
   glLineWidth(4.0f);
-  glDrawArrays(GL_LINES, 0, path_vertex_num_);
+  glEnable(GL_PRIMITIVE_RESTART);
+  glPrimitiveRestartIndex(kPrimitiveRestartIndex);
+  glDrawElements(GL_LINE_STRIP, (GLsizei)index_count, GL_UNSIGNED_INT, (void *)(trail_index_first_ * sizeof(GLuint)));
+  glDisable(GL_PRIMITIVE_RESTART);
   glLineWidth(1.0f);
 
   glBindVertexArray(0);
 }
 
-void Core::calculate_path_orientations()
+void Core::reset_track_chunks()
 {
-  if (predefined_path_.size() < 2)
-    return;
+  release_track_chunks();
+  path_chunks_.set_path(simulation_.path(), simulation_.path_file());
+  update_track_chunks();
+}
 
-  // 为每个路径点计算正确的朝向，使用简单而稳定的算法
-  for (size_t i = 0; i < predefined_path_.size(); i++)
+void Core::update_track_chunks()
+{
+  path_chunks_.set_wrap(simulation_.loop_play());
+  if (!path_chunks_.update((size_t)simulation_.current_path_index()))
   {
-    glm::vec3 direction;
+    return;
+  }
 
-    if (i == 0)
-    {
-      // 第一个点：朝向下一个点
-      direction = predefined_path_[i + 1].position - predefined_path_[i].position;
-    }
-    else if (i == predefined_path_.size() - 1)
-    {
-      // 最后一个点：朝向第一个点（闭合路径）
-      direction = predefined_path_[0].position - predefined_path_[i].position;
-    }
-    else
-    {
-      // 中间点：朝向下一个点
-      direction = predefined_path_[i + 1].position - predefined_path_[i].position;
-    }
+  const std::map<size_t, std::shared_ptr<const PathChunk>> &resident = path_chunks_.resident();
 
-    // 计算yaw角度
-    if (glm::length(direction) > 0.001f)
+  // 删除移出窗口的分块
+  for (auto it = track_chunks_.begin(); it != track_chunks_.end();)
+  {
+    if (resident.count(it->first) == 0)
     {
-      direction = glm::normalize(direction);
-      float yaw_radians = atan2(direction.x, direction.z);
-      float yaw_degrees = glm::degrees(yaw_radians);
-      predefined_path_[i].yaw = yaw_degrees;
+      glDeleteTextures(1, &it->second.texture);
+      glDeleteBuffers(1, &it->second.buffer);
+      glDeleteBuffers(1, &it->second.element_buffer);
+      it = track_chunks_.erase(it);
     }
     else
     {
-      // 如果方向向量长度太小，保持前一个点的朝向
-      if (i > 0)
-      {
-        predefined_path_[i].yaw = predefined_path_[i - 1].yaw;
-      }
-      else
-      {
-        predefined_path_[i].yaw = 0.0f;
-      }
+      ++it;
     }
   }
 
-  // 简单的角度平滑处理
-  for (size_t i = 1; i < predefined_path_.size(); i++)
+  // 上传新进入窗口或重新生成过的分块
+  for (const auto &entry : resident)
   {
-    float prev_yaw = predefined_path_[i - 1].yaw;
-    float curr_yaw = predefined_path_[i].yaw;
-
-    // 处理角度跳跃（例如从179度到-179度）
-    float diff = curr_yaw - prev_yaw;
-
-    if (diff > 180.0f)
-    {
-      predefined_path_[i].yaw -= 360.0f;
-    }
-    else if (diff < -180.0f)
+    TrackChunkBuffers &buffers = track_chunks_[entry.first];
+    if (buffers.chunk != entry.second)
     {
-      predefined_path_[i].yaw += 360.0f;
+      upload_track_chunk(buffers, entry.second);
     }
   }
 }
 
-void Core::init_track_VAOs()
-{
-  // 初始化左侧边界VAO
-  glGenVertexArrays(1, &left_track_VAO_);
-  glBindVertexArray(left_track_VAO_);
-
-  GLuint VBO_left;
-  glGenBuffers(1, &VBO_left);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO_left);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-  glEnableVertexAttribArray(0);
-
-  glBindVertexArray(0);
-  glDeleteBuffers(1, &VBO_left);
-
-  // 初始化右侧边界VAO
-  glGenVertexArrays(1, &right_track_VAO_);
-  glBindVertexArray(right_track_VAO_);
-
-  GLuint VBO_right;
-  glGenBuffers(1, &VBO_right);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO_right);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-  glEnableVertexAttribArray(0);
-
-  glBindVertexArray(0);
-  glDeleteBuffers(1, &VBO_right);
-
-  left_track_vertex_num_ = 0;
-  right_track_vertex_num_ = 0;
-}
-
-void Core::generate_track_boundaries()
+void Core::upload_track_chunk(TrackChunkBuffers &buffers, const std::shared_ptr<const PathChunk> &chunk)
 {
-  if (predefined_path_.size() < 2)
-    return;
-
-  left_track_points_.clear();
-  right_track_points_.clear();
-
-  for (size_t i = 0; i < predefined_path_.size(); i++)
+  if (buffers.buffer == 0)
   {
-    glm::vec3 position = predefined_path_[i].position;
-
-    // 计算垂直于路径的方向向量
-    glm::vec3 forward_dir;
-    if (i < predefined_path_.size() - 1)
-    {
-      forward_dir = predefined_path_[i + 1].position - position;
-    }
-    else
-    {
-      forward_dir = position - predefined_path_[i - 1].position;
-    }
-
-    if (glm::length(forward_dir) > 0.001f)
-    {
-      forward_dir = glm::normalize(forward_dir);
+    glGenBuffers(1, &buffers.buffer);
+    glGenTextures(1, &buffers.texture);
+    glGenBuffers(1, &buffers.element_buffer);
+  }
 
-      // 计算右侧方向（垂直于前进方向）
-      glm::vec3 right_dir = glm::cross(forward_dir, glm::vec3(0.0f, 1.0f, 0.0f));
-      right_dir = glm::normalize(right_dir);
+  buffers.chunk = chunk;
+  buffers.point_count = (GLsizei)chunk->track_vertices.size();
 
-      // 生成左右边界点
-      glm::vec3 left_point = position - right_dir * track_lane_width_;
-      glm::vec3 right_point = position + right_dir * track_lane_width_;
+  glBindBuffer(GL_TEXTURE_BUFFER, buffers.buffer);
+  glBufferData(GL_TEXTURE_BUFFER, chunk->track_vertices.size() * sizeof(TrackVertex), chunk->track_vertices.data(),
+               GL_STATIC_DRAW);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
 
-      left_point.y = 0.02f; // 稍微抬高避免与地面重叠
-      right_point.y = 0.02f;
+  glBindTexture(GL_TEXTURE_BUFFER, buffers.texture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffers.buffer);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
 
-      left_track_points_.push_back(left_point);
-      right_track_points_.push_back(right_point);
-    }
+  // 简化层级的每个点对应三角形带中的左右两个顶点（gl_VertexID 即下标）
+  std::vector<GLuint> strip_indices;
+  strip_indices.reserve(chunk->lod_indices.size() * 2);
+  for (uint32_t point : chunk->lod_indices)
+  {
+    strip_indices.push_back(point * 2);
+    strip_indices.push_back(point * 2 + 1);
   }
 
-  // 更新VAO
-  update_track_VAOs();
+  // 下标缓冲的绑定属于VAO状态，借用路面的空VAO上传
+  glBindVertexArray(track_VAO_);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.element_buffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, strip_indices.size() * sizeof(GLuint), strip_indices.data(), GL_STATIC_DRAW);
+  glBindVertexArray(0);
 }
 
-void Core::update_track_VAOs()
+void Core::release_track_chunks()
 {
-  // 更新左侧边界VAO
-  if (left_track_points_.size() >= 2)
-  {
-    std::vector<float> left_vertices;
-    for (size_t i = 0; i < left_track_points_.size() - 1; i++)
-    {
-      // 线段起点
-      left_vertices.push_back(left_track_points_[i].x);
-      left_vertices.push_back(left_track_points_[i].y);
-      left_vertices.push_back(left_track_points_[i].z);
-
-      // 线段终点
-      left_vertices.push_back(left_track_points_[i + 1].x);
-      left_vertices.push_back(left_track_points_[i + 1].y);
-      left_vertices.push_back(left_track_points_[i + 1].z);
-    }
-
-    left_track_vertex_num_ = left_vertices.size() / 3;
-
-    glBindVertexArray(left_track_VAO_);
-    GLuint VBO_left;
-    glGenBuffers(1, &VBO_left);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_left);
-    glBufferData(GL_ARRAY_BUFFER, left_vertices.size() * sizeof(float), left_vertices.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-
-    glBindVertexArray(0);
-    glDeleteBuffers(1, &VBO_left);
-  }
-
-  // 更新右侧边界VAO
-  if (right_track_points_.size() >= 2)
+  for (auto &entry : track_chunks_)
   {
-    std::vector<float> right_vertices;
-    for (size_t i = 0; i < right_track_points_.size() - 1; i++)
-    {
-      // 线段起点
-      right_vertices.push_back(right_track_points_[i].x);
-      right_vertices.push_back(right_track_points_[i].y);
-      right_vertices.push_back(right_track_points_[i].z);
-
-      // 线段终点
-      right_vertices.push_back(right_track_points_[i + 1].x);
-      right_vertices.push_back(right_track_points_[i + 1].y);
-      right_vertices.push_back(right_track_points_[i + 1].z);
-    }
-
-    right_track_vertex_num_ = right_vertices.size() / 3;
-
-    glBindVertexArray(right_track_VAO_);
-    GLuint VBO_right;
-    glGenBuffers(1, &VBO_right);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_right);
-    glBufferData(GL_ARRAY_BUFFER, right_vertices.size() * sizeof(float), right_vertices.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-
-    glBindVertexArray(0);
-    glDeleteBuffers(1, &VBO_right);
+    glDeleteTextures(1, &entry.second.texture);
+    glDeleteBuffers(1, &entry.second.buffer);
+    glDeleteBuffers(1, &entry.second.element_buffer);
   }
+  track_chunks_.clear();
 }
 
 void Core::render_track_boundaries()
@@ -1103,59 +1317,53 @@ void Core::render_track_boundaries()
   if (!show_track_boundaries_)
     return;
 
-  glUseProgram(shader_program_);
-
-  glm::mat4 model = glm::mat4(1.0f);
-  glm::mat4 view;
-  if (follow_model_)
-  {
-    view = glm::lookAt(
-        camera_position_,
-        model_translate,
-        glm::vec3(0.0f, 1.0f, 0.0f));
-  }
-  else
-  {
-    view = glm::lookAt(
-        camera_position_,
-        glm::vec3(0.0f, 0.0f, 0.0f),
-        glm::vec3(0.0f, 1.0f, 0.0f));
-  }
-
-  glm::mat4 projection = glm::perspective(glm::radians(55.0f), 1280.0f / 800.0f, 0.1f, 100.0f);
-
-  GLuint transformLocModel = glGetUniformLocation(shader_program_, "model");
-  glUniformMatrix4fv(transformLocModel, 1, GL_FALSE, glm::value_ptr(model));
-
-  GLuint transformLocView = glGetUniformLocation(shader_program_, "view");
-  glUniformMatrix4fv(transformLocView, 1, GL_FALSE, glm::value_ptr(view));
+  glUseProgram(track_program_);
+  glUniform1f(track_lane_width_loc_, track_lane_width_);
+  glBindVertexArray(track_VAO_);
+  glActiveTexture(GL_TEXTURE0);
 
-  GLuint transformLocProjection = glGetUniformLocation(shader_program_, "projection");
-  glUniformMatrix4fv(transformLocProjection, 1, GL_FALSE, glm::value_ptr(projection));
-
-  // 绘制左侧边界（红色）
-  if (left_track_vertex_num_ > 0)
+  // 每个分块一次绘制：路面和两侧边线在同一条三角形带里，边线由片段着色器按横向坐标着色
+  track_drawn_points_ = 0;
+  track_chunks_drawn_ = 0;
+  track_chunks_culled_ = 0;
+  for (const auto &entry : track_chunks_)
   {
-    glBindVertexArray(left_track_VAO_);
-    GLuint color_loc = glGetUniformLocation(shader_program_, "ObjectColor");
-    glUniform3f(color_loc, 1.0f, 0.0f, 0.0f); // 红色（更鲜明）
-
-    glLineWidth(5.0f);
-    glDrawArrays(GL_LINES, 0, left_track_vertex_num_);
-    glBindVertexArray(0);
-  }
+    const TrackChunkBuffers &buffers = entry.second;
+    if (buffers.point_count < 2)
+      continue;
+
+    // 路面压平在地面上，包围盒按车道宽度向外扩
+    const PathChunk &chunk = *buffers.chunk;
+    const glm::vec3 bounds_min = glm::vec3(chunk.bounds_min.x - track_lane_width_, 0.0f, chunk.bounds_min.z - track_lane_width_);
+    const glm::vec3 bounds_max = glm::vec3(chunk.bounds_max.x + track_lane_width_, 0.02f, chunk.bounds_max.z + track_lane_width_);
+    if (!frustum_.intersects(bounds_min, bounds_max))
+    {
+      track_chunks_culled_++;
+      continue;
+    }
+    track_chunks_drawn_++;
 
-  // 绘制右侧边界（青色）
-  if (right_track_vertex_num_ > 0)
-  {
-    glBindVertexArray(right_track_VAO_);
-    GLuint color_loc = glGetUniformLocation(shader_program_, "ObjectColor");
-    glUniform3f(color_loc, 0.0f, 1.0f, 1.0f); // 青色（对比度更强）
+    // 选投影误差不超过阈值的最粗一级
+    const std::vector<PathChunkLod> &levels = chunk.lod_levels;
+    float scale = projected_scale(bounds_min, bounds_max);
+    size_t level = 0;
+    while (level + 1 < levels.size() && levels[level + 1].tolerance * scale <= lod_error_pixels_)
+      level++;
 
-    glLineWidth(5.0f);
-    glDrawArrays(GL_LINES, 0, right_track_vertex_num_);
-    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_BUFFER, buffers.texture);
+    if (level == 0)
+    {
+      glDrawArrays(GL_TRIANGLE_STRIP, 0, buffers.point_count * 2);
+    }
+    else
+    {
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.element_buffer);
+      glDrawElements(GL_TRIANGLE_STRIP, (GLsizei)levels[level].count * 2, GL_UNSIGNED_INT,
+                     (void *)(levels[level].first * 2 * sizeof(GLuint)));
+    }
+    track_drawn_points_ += levels[level].count;
   }
 
-  glLineWidth(1.0f);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glBindVertexArray(0);
 }
@@ -5,94 +5,209 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <imgui.h>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "fleet.h"
+#include "frustum.h"
+#include "path_chunks.h"
+#include "profiler.h"
+#include "simulation.h"
+#include "task_pool.h"
+
+// 车队实例化渲染的每实例数据
+struct VehicleInstance
+{
+  glm::vec3 position;
+  float yaw; // 偏航角（度），与position连续存放，作为一个vec4属性读取
+  glm::vec3 color;
+};
+
 class Core
 {
 private:
-  GLuint grid_VAO_ = 0;
-  unsigned int grid_vertex_num_ = 0;
+  GLuint grid_VAO_ = 0; // 全屏三角形，没有顶点数据
   GLuint cube_VAO_ = 0;
+  GLuint cube_VBO_ = 0;
   unsigned int cub_vertex_num_ = 0;
+  GLuint fleet_VAO_ = 0;              // 车队实例化渲染（共用车身网格）
+  GLuint fleet_instance_VBO_ = 0;     // 每帧更新的实例数据
+  size_t fleet_instance_capacity_ = 0;
+  size_t fleet_instance_count_ = 0;
   GLuint path_VAO_ = 0;
-  unsigned int path_vertex_num_ = 0;
-  GLuint left_track_VAO_ = 0; // 左侧赛道边界
-  unsigned int left_track_vertex_num_ = 0;
-  GLuint right_track_VAO_ = 0; // 右侧赛道边界
-  unsigned int right_track_vertex_num_ = 0;
+  GLuint path_VBO_ = 0;                      // 常驻的轨迹顶点缓冲，与轨迹环形缓冲区一一对应
+  GLuint path_EBO_ = 0;                      // 按细节层级抽样的轨迹下标，按逻辑顺序连成一条线带
+  size_t path_VBO_capacity_ = 0;             // 缓冲区可容纳的轨迹点数
+  unsigned int path_VBO_generation_ = ~0u;   // 已上传数据对应的轨迹代数
+  unsigned long long path_VBO_pushed_ = 0;   // 已上传的累计轨迹点数
+
+  // 轨迹缓冲按物理槽位分块，每块记录包围盒和点间距，绘制时按屏幕误差选抽样步长
+  static const size_t kTrailBlockSize = 1024;
+  static const GLuint kPrimitiveRestartIndex = 0xFFFFFFFFu; // 轨迹线带断开处
+  struct TrailBlock
+  {
+    glm::vec3 bounds_min = glm::vec3(0.0f);
+    glm::vec3 bounds_max = glm::vec3(0.0f);
+    float spacing = 0.0f;       // 相邻点的平均距离
+    size_t sample_count = 0;    // 块内有效的点数
+    unsigned int stride = 1;    // 本帧的抽样步长（2 的幂）
+    bool visible = true;        // 本帧是否在视锥体内
+  };
+  std::vector<TrailBlock> trail_blocks_;
+
+  // 轨迹下标只在新增轨迹点、轨迹重置或某块的可见性、抽样步长改变时更新。抽样按全局序号进行，
+  // 每一步只取决于所在块，更新时只重算最旧一端和从最早变化的块到最新一端，中间部分原样保留
+  struct TrailStep
+  {
+    size_t offset;         // 这一步写出的第一个下标在 trail_indices_ 中的位置
+    unsigned long long id; // 这一步所在轨迹点的全局序号（按 push_count 计）
+  };
+  std::vector<GLuint> trail_indices_; // 与下标缓冲布局相同，有效部分从 trail_index_first_ 到末尾
+  std::deque<TrailStep> trail_steps_;
+  size_t trail_index_first_ = 0;
+  size_t trail_EBO_capacity_ = 0;                  // 下标缓冲可容纳的下标数
+  unsigned int trail_indices_generation_ = ~0u;    // 下标对应的轨迹代数
+  unsigned long long trail_indices_pushed_ = 0;    // 下标对应的累计轨迹点数
+
+  // 常驻路径分块的路面，一块一个纹理缓冲（中心线和法向），在着色器中挤出成三角形带
+  struct TrackChunkBuffers
+  {
+    std::shared_ptr<const PathChunk> chunk; // 上传的数据来自哪个分块，分块重建后据此重传
+    GLuint buffer = 0;
+    GLuint texture = 0;
+    GLuint element_buffer = 0; // 第 1 级起各细节层级的三角形带下标
+    GLsizei point_count = 0;
+  };
+  GLuint track_VAO_ = 0; // 路面顶点全部由 gl_VertexID 生成，核心模式下仍需绑定一个空VAO
+  std::map<size_t, TrackChunkBuffers> track_chunks_;
 
   GLuint shader_program_ = 0;
+  GLuint fleet_program_ = 0;
+  GLuint track_program_ = 0;
+  GLuint grid_program_ = 0;
+  GLint model_loc_ = -1;        // 缓存的uniform位置
+  GLint object_color_loc_ = -1;
+  GLint track_lane_width_loc_ = -1;
+
+  // 细节层级：按投影到屏幕上的误差选择，误差不超过 lod_error_pixels_
+  float lod_error_pixels_ = 1.0f;
+  size_t track_drawn_points_ = 0; // 本帧路面绘制的中心线点数
+  size_t trail_drawn_points_ = 0; // 本帧轨迹绘制的点数
+
+  // 视锥体剔除统计（本帧）
+  size_t track_chunks_drawn_ = 0;
+  size_t track_chunks_culled_ = 0;
+  size_t trail_blocks_drawn_ = 0;
+  size_t trail_blocks_culled_ = 0;
+
+  // 帧耗时统计，App 在主循环中计时各渲染流程，更新中的各步骤在这里计时
+  FrameProfiler profiler_;
+
+  // 每帧的摄像机矩阵，通过UBO共享给所有渲染流程
+  static const GLuint kCameraBindingPoint = 0;
+  GLuint camera_UBO_ = 0;
+  glm::mat4 view_ = glm::mat4(1.0f);
+  glm::mat4 projection_ = glm::mat4(1.0f);
+  glm::vec3 camera_eye_ = glm::vec3(0.0f); // 本帧摄像机在世界坐标中的位置
+  Frustum frustum_;                        // 本帧的视锥体，用于剔除路面分块和轨迹块
+  glm::vec3 render_origin_ = glm::vec3(0.0f); // 本帧的渲染原点（路径坐标），观察矩阵相对它计算
+  float near_plane_ = 0.1f;                // 投影的近平面和远平面（米）
+  float far_plane_ = 100.0f;
+  int viewport_height_ = 1;
 
   glm::vec3 camera_position_ = glm::vec3(0.0f, 1.0f, -6.0f);
   glm::vec3 model_rotation = glm::vec3(0.0f, 0.0f, 0.0f);
-  glm::vec3 model_translate = glm::vec3(0.0f, 0.0f, 0.0f);
 
   // 摄像机跟随相关
   bool follow_model_ = true;     // 是否启用模型跟随
   float camera_distance_ = 5.0f; // 摄像机距离模型的距离
   float camera_height_ = 2.0f;   // 摄像机相对模型的高度
-  float yaw_angle_ = 0.0f;       // 偏航角（左右转动）
 
-  // 路径播放相关
-  struct PathPoint
-  {
-    glm::vec3 position;
-    float yaw;
-    float timestamp; // 时间戳（秒）
-  };
-  std::vector<PathPoint> predefined_path_; // 预定义路径
-  bool is_playing_ = false;                // 是否正在播放
-  float play_start_time_ = 0.0f;           // 播放开始时间
-  float play_speed_ = 1.0f;                // 播放速度倍率
-  int current_path_index_ = 0;             // 当前路径点索引
-  bool loop_play_ = true;                  // 是否循环播放
+  // 车辆仿真（路径播放、车辆状态、走过的轨迹）
+  Simulation simulation_;
+
+  // 路径分块：只有播放位置附近的分块常驻，后台线程预取前方的分块。
+  // 引用仿真中的路径，所以声明在 simulation_ 之后，先于它析构
+  PathChunkStore path_chunks_;
 
   // 路径轨迹绘制相关
-  std::vector<glm::vec3> traveled_path_;      // 车子走过的轨迹
-  std::vector<glm::vec3> left_track_points_;  // 左侧赛道边界点
-  std::vector<glm::vec3> right_track_points_; // 右侧赛道边界点
   bool show_path_ = true;                     // 是否显示路径
   bool show_track_boundaries_ = true;         // 是否显示赛道边界
   float track_lane_width_ = 1.5f;             // 赛道车道宽度
 
+  // 车队相关
+  Fleet fleet_;                                  // 车队仿真（SoA）
+  int fleet_size_ = 0;                           // 车队车辆数
+  std::vector<glm::vec3> fleet_colors_;          // 每辆车的颜色
+  std::vector<VehicleInstance> fleet_instances_; // 本帧要绘制的车辆实例
+
+  // 车队在线程池上异步推进，写入后台快照；渲染只读前台快照，完成后两者交换
+  TaskPool task_pool_;
+  TaskGroup fleet_job_;
+  FleetSnapshot fleet_snapshots_[2];
+  int fleet_front_snapshot_ = 0;
+  bool fleet_job_pending_ = false;
+
 public:
   Core();
   ~Core();
 
+  FrameProfiler &profiler() { return profiler_; }
+  Simulation &simulation() { return simulation_; }
+  void set_fleet_size(int fleet_size); // 按新的数量重新生成车队
+  void set_clip_planes(float near_plane, float far_plane);
+
   std::pair<std::string, std::string> read_shader_file(const char *vertex_path, const char *fragment_path);
+  GLuint build_program(const char *vertex_path, const char *fragment_path);
   void init_program();
+  void init_camera_UBO();
   void init_core();
+  bool load_path_file(const std::string &file_path); // 加载二进制路径文件，替换预定义路径
+
+  void begin_frame(int width, int height); // 计算并上传本帧的摄像机矩阵
 
-  unsigned int build_grid_vertices(std::vector<float> &vertices, int grid_num);
   void init_grid_VAO();
   void init_cube_VAO();
+  void init_fleet_VAO(); // 初始化车队实例化VAO
   void init_path_VAO();   // 初始化路径VAO
-  void init_track_VAOs(); // 初始化赛道边界VAO
 
   void render_cube();
+  void render_fleet(); // 实例化渲染车队
   void render_grid();
   void render_path();             // 渲染路径
-  void render_track_boundaries(); // 渲染赛道边界
+  void render_track_boundaries(); // 渲染路面和两侧边线
   void render_tool_panel();
+  void render_scene(); // 按顺序执行全部渲染流程，窗口和离屏渲染共用
 
+  void update(double dt);      // 推进仿真并同步渲染数据
   void update_camera_follow(); // 更新摄像机跟随
 
-  // 路径播放相关方法
-  void init_predefined_path();                                                       // 初始化预定义路径
-  void update_path_playback();                                                       // 更新路径播放
-  void start_path_playback();                                                        // 开始播放
-  void stop_path_playback();                                                         // 停止播放
-  void reset_path_playback();                                                        // 重置播放
-  glm::vec3 interpolate_position(const PathPoint &p1, const PathPoint &p2, float t); // 位置插值
-  float interpolate_yaw(float yaw1, float yaw2, float t);                            // 角度插值
+  // 车队相关方法
+  void init_fleet();                                                          // 按车队数量重新生成车队
+  void reset_fleet();                                                         // 所有车辆回到起始偏移
+  void submit_fleet_update(double dt);                                        // 异步推进车队，结果写入后台快照
+  void finish_fleet_update();                                                 // 等待异步推进完成并交换前后台快照
+  void pack_fleet_instances();                                                // 把车队状态打包成实例数据
+  void update_fleet_instances(const std::vector<VehicleInstance> &instances); // 上传本帧的实例数据
 
   // 路径轨迹相关方法
-  void update_traveled_path();        // 更新走过的轨迹
-  void clear_traveled_path();         // 清空轨迹
-  void update_path_VAO();             // 更新路径VAO
-  void calculate_path_orientations(); // 计算路径朝向
-  void generate_track_boundaries();   // 生成赛道边界
-  void update_track_VAOs();           // 更新赛道边界VAO
+  void update_path_VAO();           // 更新路径VAO（只上传新增的轨迹点）
+  void upload_path_samples(size_t first, size_t count); // 上传逻辑区间内的轨迹点到常驻缓冲
+  void refresh_trail_blocks(size_t first_slot, size_t count); // 重新统计物理槽位区间所在块的包围盒和点间距
+  size_t classify_trail_blocks();   // 剔除并选择各块的抽样步长，返回可见性或步长改变的块中最旧点的逻辑下标，没有时为 SIZE_MAX
+  void update_trail_indices();      // 按需更新轨迹下标和下标缓冲
+  void rebuild_trail_indices();     // 整体重新抽样并上传
+  bool patch_trail_indices(size_t first_changed); // 只重算变化的两端并上传，做不到时返回 false
+  void walk_trail(unsigned long long id); // 从全局序号 id 的点抽样到最新的点，追加到下标末尾
+  size_t trail_step(unsigned long long id, GLuint *entries, unsigned long long &next) const; // 抽样一步，写出最多 3 个下标
+  float projected_scale(const glm::vec3 &bounds_min, const glm::vec3 &bounds_max) const; // 包围盒最近处每米对应的像素数
+  void reset_track_chunks();        // 路径改变后重新生成所有分块
+  void update_track_chunks();       // 移动常驻窗口，按常驻分块增删路面缓冲
+  void upload_track_chunk(TrackChunkBuffers &buffers, const std::shared_ptr<const PathChunk> &chunk);
+  void release_track_chunks();      // 删除所有路面缓冲
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include "fleet.h"
+#include "interpolation.h"
+#include <algorithm>
+#include <cmath>
+
+// 顺序推进时先线性向前试探的段数，超过后改用二分查找
+static const int kCursorScanLimit = 8;
+// 并行推进时每块的最少车辆数，块太小时调度开销会超过计算量
+static const size_t kMinParallelGrain = 2048;
+
+void Fleet::set_path(const PathView &path)
+{
+  path_ = path;
+  path_duration_ = path.empty() ? 0.0 : path.back().timestamp;
+  reset();
+}
+
+size_t Fleet::add_vehicle(double start_offset, float speed, bool loop_play, float lateral_offset)
+{
+  start_offsets_.push_back(start_offset);
+  speeds_.push_back(speed);
+  lateral_offsets_.push_back(lateral_offset);
+  loop_masks_.push_back(loop_play ? 1.0 : 0.0);
+
+  times_.push_back(start_offset);
+  indices_.push_back(0);
+  progress_.push_back(0.0f);
+  position_x_.push_back(0.0f);
+  position_y_.push_back(0.0f);
+  position_z_.push_back(0.0f);
+  yaws_.push_back(0.0f);
+
+  // 新车辆立即定位到起始位置
+  size_t index = times_.size() - 1;
+  update_range(index, index + 1, 0.0);
+  return index;
+}
+
+void Fleet::populate(size_t count)
+{
+  clear();
+
+  for (size_t i = 0; i < count; i++)
+  {
+    // 起始偏移在路径时长内均匀分布，速度和车道由下标散列得到，结果可复现
+    uint32_t hash = (uint32_t)i * 2654435761u;
+    double start_offset = path_duration_ * (double)i / (double)count;
+    float speed = 0.8f + 0.4f * (float)(hash >> 8) / (float)(1u << 24);
+    float lane = (float)(i % 5) - 2.0f;
+    add_vehicle(start_offset, speed, true, lane * 0.5f);
+  }
+}
+
+void Fleet::clear()
+{
+  start_offsets_.clear();
+  speeds_.clear();
+  lateral_offsets_.clear();
+  loop_masks_.clear();
+  times_.clear();
+  indices_.clear();
+  progress_.clear();
+  position_x_.clear();
+  position_y_.clear();
+  position_z_.clear();
+  yaws_.clear();
+}
+
+void Fleet::reset()
+{
+  times_ = start_offsets_;
+  std::fill(indices_.begin(), indices_.end(), 0);
+  update_range(0, size(), 0.0);
+}
+
+void Fleet::step(double dt)
+{
+  update_range(0, size(), dt);
+}
+
+void Fleet::step(double dt, TaskPool &pool, FleetSnapshot *snapshot)
+{
+  const size_t count = size();
+  if (snapshot != nullptr)
+  {
+    snapshot->position_x.resize(count);
+    snapshot->position_y.resize(count);
+    snapshot->position_z.resize(count);
+    snapshot->yaws.resize(count);
+  }
+
+  // 每个线程约分到四块，留出窃取的余地；块大小取 64 的倍数，块边界不会落在 SIMD 向量中间，
+  // 结果与不分块时逐位一致，相邻块也不会写同一缓存行
+  size_t grain = std::max(kMinParallelGrain, count / (pool.concurrency() * 4) + 1);
+  grain = (grain + 63) & ~(size_t)63;
+  pool.parallel_for(count, grain, [this, dt, snapshot](size_t begin, size_t end) {
+    update_range(begin, end, dt);
+    // 趁数据还在缓存里写出快照
+    if (snapshot != nullptr)
+    {
+      copy_snapshot_range(*snapshot, begin, end);
+    }
+  });
+}
+
+void Fleet::update_range(size_t begin, size_t end, double dt)
+{
+  if (path_.size() < 2 || begin >= end)
+  {
+    return;
+  }
+
+  // 分三遍处理：时间推进和插值都是无分支的逐元素运算，只有游标推进和段内定位是标量循环
+  advance_times(begin, end, dt);
+  locate_segments(begin, end);
+  interpolate_states(begin, end);
+}
+
+int Fleet::find_path_segment(double time) const
+{
+  auto it = std::upper_bound(path_.begin(), path_.end(), time,
+                             [](double value, const PathPoint &point) { return value < point.timestamp; });
+  int index = (int)(it - path_.begin()) - 1;
+  return glm::clamp(index, 0, (int)path_.size() - 2);
+}
+
+// 逐车推进时间的内核：GCC 只对函数参数上的 __restrict 做别名分析，所以独立成函数
+static void advance_times_kernel(size_t begin, size_t end, double dt, double duration,
+                                 double *__restrict times, const double *__restrict speeds,
+                                 const double *__restrict loop_masks)
+{
+  const double inv_duration = duration > 0.0 ? 1.0 / duration : 0.0;
+
+  for (size_t i = begin; i < end; i++)
+  {
+    double time = std::max(times[i] + dt * speeds[i], 0.0);
+
+    // 循环的车辆对时长取模（时间非负，截断即向下取整），不循环的停在终点
+    // 用掩码混合两种结果，循环体内没有分支
+    double wrapped = time - (double)(int)(time * inv_duration) * duration;
+    double clamped = std::min(time, duration);
+    times[i] = clamped + loop_masks[i] * (wrapped - clamped);
+  }
+}
+
+void Fleet::advance_times(size_t begin, size_t end, double dt)
+{
+  advance_times_kernel(begin, end, dt, path_duration_, times_.data(), speeds_.data(), loop_masks_.data());
+}
+
+void Fleet::locate_segments(size_t begin, size_t end)
+{
+  const int last_segment = (int)path_.size() - 2;
+  const PathPoint *points = path_.points;
+
+  for (size_t i = begin; i < end; i++)
+  {
+    double time = times_[i];
+    int index = indices_[i];
+
+    if (index > last_segment || time < points[index].timestamp)
+    {
+      // 时间回退（循环回到起点）时直接二分查找
+      index = find_path_segment(time);
+    }
+    else
+    {
+      // 每步通常只前进零到一段，先线性试探
+      int scanned = 0;
+      while (index < last_segment && time > points[index + 1].timestamp && scanned < kCursorScanLimit)
+      {
+        index++;
+        scanned++;
+      }
+
+      if (scanned == kCursorScanLimit && index < last_segment && time > points[index + 1].timestamp)
+      {
+        index = find_path_segment(time);
+      }
+    }
+    indices_[i] = index;
+
+    // 段内进度在双精度下计算，落在 [0, 1] 内后再转成 float
+    double segment_duration = points[index + 1].timestamp - points[index].timestamp;
+    double t = segment_duration > 0.0 ? (time - points[index].timestamp) / segment_duration : 0.0;
+    progress_[i] = (float)std::min(std::max(t, 0.0), 1.0);
+  }
+}
+
+void Fleet::interpolate_states(size_t begin, size_t end)
+{
+  const VehicleColumns vehicles = {progress_.data(), indices_.data(), lateral_offsets_.data(),
+                                   position_x_.data(), position_y_.data(), position_z_.data(), yaws_.data()};
+  interpolate_batch(path_, vehicles, begin, end);
+}
+
+void Fleet::copy_snapshot_range(FleetSnapshot &snapshot, size_t begin, size_t end) const
+{
+  std::copy(position_x_.begin() + begin, position_x_.begin() + end, snapshot.position_x.begin() + begin);
+  std::copy(position_y_.begin() + begin, position_y_.begin() + end, snapshot.position_y.begin() + begin);
+  std::copy(position_z_.begin() + begin, position_z_.begin() + end, snapshot.position_z.begin() + begin);
+  std::copy(yaws_.begin() + begin, yaws_.begin() + end, snapshot.yaws.begin() + begin);
+}
@@ -0,0 +1,74 @@
+#ifndef __FLEET_H
+#define __FLEET_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "simulation.h"
+#include "task_pool.h"
+
+// 车队状态的只读快照：并行更新完成后整体交给渲染，之后不再修改
+struct FleetSnapshot
+{
+  std::vector<float> position_x;
+  std::vector<float> position_y;
+  std::vector<float> position_z;
+  std::vector<float> yaws;
+
+  size_t size() const { return yaws.size(); }
+};
+
+// 多车辆仿真：所有车辆沿同一条路径行驶，各自有起始偏移、速度和是否循环
+// 状态按列（SoA）存放，逐车更新的循环可以被编译器向量化。路径不拷贝，直接读取 PathView
+// （可以是映射的路径文件），内存占用只与车辆数有关；时间用双精度推进和定位，
+// 只有段内进度（[0, 1] 内的小数）转成 float 交给插值内核，长记录上也不会丢失精度
+class Fleet
+{
+private:
+  PathView path_; // 在下次 set_path 之前必须有效
+  double path_duration_ = 0.0;
+
+  // 每辆车的参数
+  std::vector<double> start_offsets_;  // 起始时间偏移（秒）
+  std::vector<double> speeds_;         // 速度倍率
+  std::vector<float> lateral_offsets_; // 车道横向偏移（向右为正）
+  std::vector<double> loop_masks_;     // 是否循环（1 或 0，用于无分支混合）
+
+  // 每辆车的状态
+  std::vector<double> times_;   // 当前路径时间
+  std::vector<int> indices_;    // 当前路径段索引（顺序推进的游标）
+  std::vector<float> progress_; // 段内进度
+  std::vector<float> position_x_;
+  std::vector<float> position_y_;
+  std::vector<float> position_z_;
+  std::vector<float> yaws_; // 偏航角（度）
+
+public:
+  void set_path(const PathView &path); // 设置路径并重置所有车辆
+  size_t add_vehicle(double start_offset, float speed, bool loop_play, float lateral_offset = 0.0f);
+  void populate(size_t count); // 生成 count 辆沿路径均匀分布的车辆（替换现有车辆）
+  void clear();                // 移除所有车辆
+  void reset();                // 所有车辆回到各自的起始偏移
+
+  void step(double dt);                                 // 推进所有车辆
+  void step(double dt, TaskPool &pool, FleetSnapshot *snapshot = nullptr); // 分块并行推进，可顺带写出快照
+  void update_range(size_t begin, size_t end, double dt); // 推进 [begin, end) 内的车辆，不同区间互不影响
+
+  size_t size() const { return times_.size(); }
+  double path_duration() const { return path_duration_; }
+  const std::vector<float> &position_x() const { return position_x_; }
+  const std::vector<float> &position_y() const { return position_y_; }
+  const std::vector<float> &position_z() const { return position_z_; }
+  const std::vector<float> &yaws() const { return yaws_; }
+  const std::vector<double> &times() const { return times_; }
+  const std::vector<int> &indices() const { return indices_; }
+
+private:
+  int find_path_segment(double time) const;
+  void advance_times(size_t begin, size_t end, double dt);
+  void locate_segments(size_t begin, size_t end);
+  void interpolate_states(size_t begin, size_t end);
+  void copy_snapshot_range(FleetSnapshot &snapshot, size_t begin, size_t end) const;
+};
+
+#endif
@@ -0,0 +1,430 @@
+#include "frame_capture.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+  uint32_t crc32_update(uint32_t crc, const unsigned char *data, size_t size)
+  {
+    static uint32_t table[256] = {};
+    if (table[1] == 0)
+    {
+      for (uint32_t i = 0; i < 256; i++)
+      {
+        uint32_t value = i;
+        for (int bit = 0; bit < 8; bit++)
+          value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+        table[i] = value;
+      }
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+      crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+  }
+
+  void append_be32(std::vector<unsigned char> &out, uint32_t value)
+  {
+    out.push_back((unsigned char)(value >> 24));
+    out.push_back((unsigned char)(value >> 16));
+    out.push_back((unsigned char)(value >> 8));
+    out.push_back((unsigned char)value);
+  }
+
+  void write_png_chunk(std::ofstream &file, const char *type, const std::vector<unsigned char> &data)
+  {
+    std::vector<unsigned char> header;
+    append_be32(header, (uint32_t)data.size());
+    header.insert(header.end(), type, type + 4);
+    file.write((const char *)header.data(), header.size());
+    file.write((const char *)data.data(), data.size());
+
+    uint32_t crc = crc32_update(0, (const unsigned char *)type, 4);
+    crc = crc32_update(crc, data.data(), data.size());
+    std::vector<unsigned char> trailer;
+    append_be32(trailer, crc);
+    file.write((const char *)trailer.data(), trailer.size());
+  }
+
+  // BT.601 有限范围
+  inline unsigned char rgb_to_y(int r, int g, int b) { return (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16); }
+  inline unsigned char rgb_to_u(int r, int g, int b) { return (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128); }
+  inline unsigned char rgb_to_v(int r, int g, int b) { return (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128); }
+}
+
+FrameCapture::~FrameCapture()
+{
+  close();
+}
+
+bool FrameCapture::open(CaptureFormat format, const std::string &path, int width, int height, double fps, size_t buffer_count)
+{
+  close();
+  path_ = path;
+  if (width <= 0 || height <= 0 || fps <= 0.0 || buffer_count < 2)
+  {
+    diagnostics() << "ERROR::CAPTURE::INVALID_OPTIONS: size and fps must be positive, at least 2 buffers" << std::endl;
+    return false;
+  }
+
+  format_ = format;
+  width_ = width;
+  height_ = height;
+  fps_ = fps;
+
+  if (format_ == CaptureFormat::kY4m)
+  {
+    stream_ = path_ == "-" ? stdout : std::fopen(path_.c_str(), "wb");
+    if (stream_ == nullptr)
+    {
+      diagnostics() << "ERROR::CAPTURE::OUTPUT_NOT_WRITABLE: " << path_ << std::endl;
+      return false;
+    }
+    std::fprintf(stream_, "YUV4MPEG2 W%d H%d F%ld:1000 Ip A1:1 C420jpeg\n", width_, height_, std::lround(fps_ * 1000.0));
+  }
+
+  // 每个像素缓冲存一整帧 RGBA，按行对齐不需要额外填充
+  buffers_.resize(buffer_count);
+  for (PixelBuffer &pixel_buffer : buffers_)
+  {
+    glGenBuffers(1, &pixel_buffer.buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer.buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width_ * height_ * 4, nullptr, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  next_buffer_ = 0;
+
+  frame_count_ = 0;
+  submitted_ = 0;
+  dropped_readback_ = 0;
+  dropped_encode_ = 0;
+  written_ = 0;
+  stopping_ = false;
+  write_failed_ = false;
+  thread_ = std::thread(&FrameCapture::worker_loop, this);
+  return true;
+}
+
+void FrameCapture::capture()
+{
+  if (buffers_.empty())
+  {
+    return;
+  }
+
+  // 先取走已经读完的帧；GPU 按顺序执行，从最早发起的开始，遇到没读完的就停
+  for (size_t i = 0; i < buffers_.size(); i++)
+  {
+    PixelBuffer &pixel_buffer = buffers_[(next_buffer_ + i) % buffers_.size()];
+    if (pixel_buffer.fence != nullptr && !collect(pixel_buffer, false))
+      break;
+  }
+
+  const size_t frame_index = frame_count_++;
+  PixelBuffer &pixel_buffer = buffers_[next_buffer_];
+  if (pixel_buffer.fence != nullptr && lossless_)
+  {
+    collect(pixel_buffer, true);
+  }
+  if (pixel_buffer.fence != nullptr)
+  {
+    // 所有像素缓冲都在读回中，为了不等待丢掉这一帧
+    dropped_readback_++;
+    return;
+  }
+
+  // 读到像素缓冲里，glReadPixels 立即返回
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer.buffer);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, (void *)0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  pixel_buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  pixel_buffer.frame_index = frame_index;
+
+  submitted_++;
+  next_buffer_ = (next_buffer_ + 1) % buffers_.size();
+}
+
+bool FrameCapture::collect(PixelBuffer &pixel_buffer, bool wait)
+{
+  // 不等待时只查询一次；结束录制时才真正等待
+  const GLuint64 timeout = wait ? 1000000000ull : 0;
+  GLenum status;
+  do
+  {
+    status = glClientWaitSync(pixel_buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+  } while (wait && status == GL_TIMEOUT_EXPIRED);
+  if (status == GL_TIMEOUT_EXPIRED)
+  {
+    return false;
+  }
+  glDeleteSync(pixel_buffer.fence);
+  pixel_buffer.fence = nullptr;
+
+  const size_t size = (size_t)width_ * height_ * 4;
+  Frame frame;
+  frame.index = pixel_buffer.frame_index;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (lossless_)
+    {
+      space_.wait(lock, [this]() { return queue_.size() < max_queued_frames_; });
+    }
+    if (queue_.size() >= max_queued_frames_)
+    {
+      // 编码跟不上，丢掉这一帧，像素缓冲照常回收
+      dropped_encode_++;
+      return true;
+    }
+    if (!free_pixels_.empty())
+    {
+      frame.pixels.swap(free_pixels_.back());
+      free_pixels_.pop_back();
+    }
+  }
+  frame.pixels.resize(size);
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer.buffer);
+  const void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)size, GL_MAP_READ_BIT);
+  if (mapped != nullptr)
+  {
+    std::memcpy(frame.pixels.data(), mapped, size);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (mapped == nullptr)
+  {
+    diagnostics() << "ERROR::CAPTURE::MAP_FAILED: frame " << frame.index << std::endl;
+    dropped_readback_++;
+    return true;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(frame));
+  }
+  wake_.notify_one();
+  return true;
+}
+
+bool FrameCapture::close()
+{
+  if (buffers_.empty())
+  {
+    return true;
+  }
+
+  // 剩下的读回按发起顺序等完，结束时不再丢帧
+  lossless_ = true;
+  for (size_t i = 0; i < buffers_.size(); i++)
+  {
+    PixelBuffer &pixel_buffer = buffers_[(next_buffer_ + i) % buffers_.size()];
+    if (pixel_buffer.fence != nullptr)
+      collect(pixel_buffer, true);
+  }
+
+  // 后台线程写完队列中的帧才退出
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  thread_.join();
+
+  for (PixelBuffer &pixel_buffer : buffers_)
+  {
+    glDeleteBuffers(1, &pixel_buffer.buffer);
+  }
+  buffers_.clear();
+  free_pixels_.clear();
+
+  if (stream_ != nullptr)
+  {
+    if (std::fflush(stream_) != 0)
+      write_failed_ = true;
+    if (stream_ != stdout)
+      std::fclose(stream_);
+    stream_ = nullptr;
+  }
+  return !write_failed_;
+}
+
+size_t FrameCapture::written()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return written_;
+}
+
+std::ostream &FrameCapture::diagnostics() const
+{
+  // 视频流写到标准输出时，错误信息混进去会破坏流
+  return path_ == "-" ? std::cerr : std::cout;
+}
+
+void FrameCapture::worker_loop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+    if (queue_.empty())
+    {
+      return; // 只有 stopping_ 且队列已空时才会到这里
+    }
+
+    Frame frame = std::move(queue_.front());
+    queue_.pop_front();
+    space_.notify_one();
+    const bool failed = write_failed_;
+
+    lock.unlock();
+    // 写失败一次之后不再写，避免每帧都输出同样的错误
+    const bool ok = !failed && write_frame(frame);
+    lock.lock();
+
+    if (ok)
+      written_++;
+    else
+      write_failed_ = true;
+    free_pixels_.push_back(std::move(frame.pixels));
+  }
+}
+
+bool FrameCapture::write_frame(const Frame &frame)
+{
+  return format_ == CaptureFormat::kY4m ? write_y4m(frame) : write_png(frame);
+}
+
+bool FrameCapture::write_png(const Frame &frame) const
+{
+  char file_name[32];
+  std::snprintf(file_name, sizeof(file_name), "/frame_%06zu.png", frame.index);
+  const std::string file_path = path_ + file_name;
+  std::ofstream file(file_path, std::ios::binary);
+  if (!file)
+  {
+    diagnostics() << "ERROR::CAPTURE::FRAME_NOT_WRITABLE: " << file_path << std::endl;
+    return false;
+  }
+
+  // 8 位 RGB，每行前加过滤类型 0，自上而下
+  const size_t row_bytes = (size_t)width_ * 3 + 1;
+  std::vector<unsigned char> raw(row_bytes * height_);
+  for (int y = 0; y < height_; y++)
+  {
+    unsigned char *row = raw.data() + y * row_bytes;
+    const unsigned char *source = frame.pixels.data() + (size_t)(height_ - 1 - y) * width_ * 4;
+    row[0] = 0;
+    for (int x = 0; x < width_; x++)
+    {
+      row[1 + x * 3] = source[x * 4];
+      row[2 + x * 3] = source[x * 4 + 1];
+      row[3 + x * 3] = source[x * 4 + 2];
+    }
+  }
+
+  // zlib 流只用不压缩的存储块：编码代价与一次内存拷贝相当，录制时跟得上帧率，需要小文件时再离线压缩
+  std::vector<unsigned char> idat;
+  idat.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+  idat.push_back(0x78);
+  idat.push_back(0x01);
+  for (size_t offset = 0; offset < raw.size(); offset += 65535)
+  {
+    const size_t length = std::min(raw.size() - offset, (size_t)65535);
+    idat.push_back(offset + length >= raw.size() ? 1 : 0); // BFINAL，BTYPE = 00
+    idat.push_back((unsigned char)length);
+    idat.push_back((unsigned char)(length >> 8));
+    idat.push_back((unsigned char)~length);
+    idat.push_back((unsigned char)(~length >> 8));
+    idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + length);
+  }
+
+  uint32_t a = 1, b = 0;
+  for (size_t offset = 0; offset < raw.size(); offset += 5552)
+  {
+    // 每 5552 字节取一次模，中间不会溢出
+    const size_t end = std::min(offset + 5552, raw.size());
+    for (size_t i = offset; i < end; i++)
+    {
+      a += raw[i];
+      b += a;
+    }
+    a %= 65521;
+    b %= 65521;
+  }
+  append_be32(idat, (b << 16) | a);
+
+  static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  file.write((const char *)signature, sizeof(signature));
+
+  std::vector<unsigned char> header;
+  append_be32(header, (uint32_t)width_);
+  append_be32(header, (uint32_t)height_);
+  header.insert(header.end(), {8, 2, 0, 0, 0}); // 位深 8，RGB，默认压缩/过滤，不隔行
+  write_png_chunk(file, "IHDR", header);
+  write_png_chunk(file, "IDAT", idat);
+  write_png_chunk(file, "IEND", std::vector<unsigned char>());
+
+  if (!file)
+  {
+    diagnostics() << "ERROR::CAPTURE::FRAME_NOT_WRITABLE: " << file_path << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool FrameCapture::write_y4m(const Frame &frame)
+{
+  // 4:2:0，色度取 2x2 块的平均；奇数尺寸时最后一行/列单独成块
+  const int chroma_width = (width_ + 1) / 2;
+  const int chroma_height = (height_ + 1) / 2;
+  std::vector<unsigned char> planes((size_t)width_ * height_ + (size_t)chroma_width * chroma_height * 2);
+  unsigned char *y_plane = planes.data();
+  unsigned char *u_plane = y_plane + (size_t)width_ * height_;
+  unsigned char *v_plane = u_plane + (size_t)chroma_width * chroma_height;
+
+  auto pixel = [&](int x, int y) { return frame.pixels.data() + ((size_t)(height_ - 1 - y) * width_ + x) * 4; };
+  for (int y = 0; y < height_; y++)
+  {
+    for (int x = 0; x < width_; x++)
+    {
+      const unsigned char *p = pixel(x, y);
+      y_plane[(size_t)y * width_ + x] = rgb_to_y(p[0], p[1], p[2]);
+    }
+  }
+  for (int cy = 0; cy < chroma_height; cy++)
+  {
+    for (int cx = 0; cx < chroma_width; cx++)
+    {
+      int r = 0, g = 0, b = 0, count = 0;
+      for (int y = cy * 2; y < std::min(cy * 2 + 2, height_); y++)
+      {
+        for (int x = cx * 2; x < std::min(cx * 2 + 2, width_); x++)
+        {
+          const unsigned char *p = pixel(x, y);
+          r += p[0];
+          g += p[1];
+          b += p[2];
+          count++;
+        }
+      }
+      r /= count;
+      g /= count;
+      b /= count;
+      u_plane[(size_t)cy * chroma_width + cx] = rgb_to_u(r, g, b);
+      v_plane[(size_t)cy * chroma_width + cx] = rgb_to_v(r, g, b);
+    }
+  }
+
+  if (std::fputs("FRAME\n", stream_) < 0 || std::fwrite(planes.data(), 1, planes.size(), stream_) != planes.size())
+  {
+    diagnostics() << "ERROR::CAPTURE::STREAM_WRITE_FAILED: " << path_ << std::endl;
+    return false;
+  }
+  return true;
+}
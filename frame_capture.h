@@ -0,0 +1,108 @@
+#ifndef __FRAME_CAPTURE_H
+#define __FRAME_CAPTURE_H
+#include <glad/glad.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 录制输出格式
+enum class CaptureFormat
+{
+  kPngSequence, // 目录下的 frame_000000.png, frame_000001.png, ...
+  kY4m,         // YUV4MPEG2 原始视频流（4:2:0），可以直接交给 ffmpeg
+};
+
+// 帧录制：帧缓冲经由一圈像素缓冲对象异步读回，GPU 完成拷贝后（用栅栏判断，不等待）才映射，
+// 读回的帧交给后台线程编码写出。读回比渲染晚 buffer_count - 1 帧，渲染线程不会因为录制停下来等待；
+// 像素缓冲还没读完、或者后台线程积压太多时丢弃当前帧并计数。
+// 离屏批量导出不在乎渲染变慢，可以改为等待，一帧也不丢
+class FrameCapture
+{
+private:
+  // 一个像素缓冲对象及其中那一帧的状态
+  struct PixelBuffer
+  {
+    GLuint buffer = 0;
+    GLsync fence = nullptr; // 非空表示有一帧正在读回
+    size_t frame_index = 0;
+  };
+
+  // 读回到内存、等待编码的一帧
+  struct Frame
+  {
+    size_t index = 0;
+    std::vector<unsigned char> pixels; // RGBA，自下而上
+  };
+
+  CaptureFormat format_ = CaptureFormat::kPngSequence;
+  std::string path_; // 图像目录，或 Y4M 文件（"-" 表示标准输出）
+  int width_ = 0;
+  int height_ = 0;
+  double fps_ = 60.0;
+
+  std::vector<PixelBuffer> buffers_;
+  size_t next_buffer_ = 0;
+  size_t max_queued_frames_ = 8;
+  bool lossless_ = false; // 为真时等待读回和编码，不丢帧
+
+  // 统计
+  size_t frame_count_ = 0;      // capture() 调用次数，即帧序号
+  size_t submitted_ = 0;        // 发起读回的帧数
+  size_t dropped_readback_ = 0; // 像素缓冲还在读回而丢弃的帧数
+  size_t dropped_encode_ = 0;   // 编码积压而丢弃的帧数
+  size_t written_ = 0;          // 已写出的帧数，后台线程更新
+
+  // 后台编码线程
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable space_; // 队列有空位（不丢帧时等待）
+  std::deque<Frame> queue_;
+  std::vector<std::vector<unsigned char>> free_pixels_; // 复用的像素内存
+  bool stopping_ = false;
+  bool write_failed_ = false;
+  std::FILE *stream_ = nullptr; // Y4M 输出
+
+public:
+  static const size_t kDefaultBufferCount = 3;
+
+  FrameCapture() = default;
+  ~FrameCapture();
+  FrameCapture(const FrameCapture &) = delete;
+  FrameCapture &operator=(const FrameCapture &) = delete;
+
+  // 需要当前有 GL 上下文。失败时输出原因并返回 false
+  bool open(CaptureFormat format, const std::string &path, int width, int height, double fps,
+            size_t buffer_count = kDefaultBufferCount);
+
+  void set_lossless(bool lossless) { lossless_ = lossless; }
+
+  // 渲染完一帧后调用：取走已经读回的帧，再把当前读帧缓冲的内容读入下一个像素缓冲
+  void capture();
+
+  // 等待所有读回和编码完成并关闭输出。返回是否全部写出成功
+  bool close();
+
+  bool is_open() const { return !buffers_.empty(); }
+  size_t submitted() const { return submitted_; }
+  size_t dropped() const { return dropped_readback_ + dropped_encode_; }
+  size_t dropped_readback() const { return dropped_readback_; }
+  size_t dropped_encode() const { return dropped_encode_; }
+  size_t written();
+
+private:
+  bool collect(PixelBuffer &pixel_buffer, bool wait); // 读回完成时映射并交给编码线程，还没读完返回 false
+  std::ostream &diagnostics() const;                  // 错误信息的输出流，录制到标准输出时为标准错误
+  void worker_loop();
+  bool write_frame(const Frame &frame);
+  bool write_png(const Frame &frame) const;
+  bool write_y4m(const Frame &frame);
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __FRUSTUM_H
+#define __FRUSTUM_H
+#include <glm/glm.hpp>
+
+// 视锥体：六个平面从投影矩阵与观察矩阵的乘积中直接取出（Gribb-Hartmann），
+// 法向朝内，点 p 在平面内侧当且仅当 dot(n, p) + d >= 0
+struct Frustum
+{
+  glm::vec4 planes[6]; // 左、右、下、上、近、远
+
+  void set(const glm::mat4 &view_projection)
+  {
+    // glm 按列存储，m[c][r] 为第 r 行第 c 列
+    const glm::mat4 &m = view_projection;
+    for (int i = 0; i < 3; i++)
+    {
+      glm::vec4 row = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+      glm::vec4 w = glm::vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+      planes[i * 2] = w + row;
+      planes[i * 2 + 1] = w - row;
+    }
+  }
+
+  // 包围盒是否与视锥体相交。只检查包围盒离每个平面最远的角，个别视锥体外的包围盒会判为相交，
+  // 对剔除来说只是少剔除一些
+  bool intersects(const glm::vec3 &bounds_min, const glm::vec3 &bounds_max) const
+  {
+    for (const glm::vec4 &plane : planes)
+    {
+      glm::vec3 corner(plane.x >= 0.0f ? bounds_max.x : bounds_min.x,
+                       plane.y >= 0.0f ? bounds_max.y : bounds_min.y,
+                       plane.z >= 0.0f ? bounds_max.z : bounds_min.z);
+      if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+#endif
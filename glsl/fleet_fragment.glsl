@@ -0,0 +1,8 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 VehicleColor;
+
+void main() {
+  FragColor = vec4(VehicleColor, 1.0f);
+}
@@ -0,0 +1,28 @@
+#version 330 core
+
+layout( location = 0 ) in vec3 aPos;
+layout( location = 1 ) in vec4 aInstance; // xyz 车辆位置, w 偏航角（度）
+layout( location = 2 ) in vec3 aColor;
+
+layout( std140 ) uniform Camera
+{
+  mat4 view;
+  mat4 projection;
+  mat4 inverse_view_projection;
+  vec4 render_origin; // 渲染原点（路径坐标），view 作用于减去它之后的坐标
+};
+
+out vec3 VehicleColor;
+
+void main()
+{
+  // 绕Y轴旋转，与 glm::rotate(yaw, (0, 1, 0)) 一致
+  float yaw = radians(aInstance.w);
+  float s = sin(yaw);
+  float c = cos(yaw);
+  vec3 rotated = vec3(c * aPos.x + s * aPos.z, aPos.y, -s * aPos.x + c * aPos.z);
+
+  VehicleColor = aColor;
+  // 先减去渲染原点，两个相近的大数相减没有误差，之后都是小坐标
+  gl_Position = projection * (view * vec4((aInstance.xyz - render_origin.xyz) + rotated, 1.0f));
+}
@@ -0,0 +1,39 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 NearPoint;
+in vec3 FarPoint;
+
+const float kMinorCell = 1.0f;     // 细网格间距（米）
+const float kMajorCell = 10.0f;    // 粗网格间距
+const float kFadeStart = 0.4f;     // 开始淡出的位置（近平面到远平面的比例），远平面调远时网格随之延伸
+const float kFadeEnd = 0.9f;       // 完全消失的位置，在远平面之前
+const vec3 kLineColor = vec3(0.0f, 0.0f, 0.0f);
+
+// 网格线的覆盖度：按屏幕空间导数确定线宽，任何距离下都约为一个像素，不会走样
+float grid_coverage(vec2 coord, float cell)
+{
+  vec2 scaled = coord / cell;
+  vec2 derivative = fwidth(scaled);
+  vec2 distance_to_line = abs(fract(scaled - 0.5f) - 0.5f) / derivative;
+  float coverage = 1.0f - min(min(distance_to_line.x, distance_to_line.y), 1.0f);
+
+  // 格子小到一两个像素时线会糊成一片，提前淡出，由更粗一级的网格接替
+  return coverage * (1.0f - smoothstep(0.2f, 0.5f, max(derivative.x, derivative.y)));
+}
+
+void main() {
+  // 视线与 y = 0 平面的交点，t 不在 (0, 1) 内说明地面不在视锥体内。
+  // 渲染原点在粗网格间距的整数倍上，相对坐标上的网格线与路径坐标一致
+  float t = -NearPoint.y / (FarPoint.y - NearPoint.y);
+  vec3 position = NearPoint + t * (FarPoint - NearPoint);
+
+  float minor = grid_coverage(position.xz, kMinorCell) * 0.5f;
+  float major = grid_coverage(position.xz, kMajorCell);
+  float fade = 1.0f - smoothstep(kFadeStart, kFadeEnd, t);
+
+  float alpha = max(minor, major) * fade;
+  if (t <= 0.0f || t >= 1.0f || alpha <= 0.0f)
+    discard;
+  FragColor = vec4(kLineColor, alpha);
+}
@@ -0,0 +1,27 @@
+#version 330 core
+
+// 覆盖全屏的三角形，顶点由 gl_VertexID 生成；每个像素沿视线与地面求交，网格在片段着色器中计算
+layout( std140 ) uniform Camera
+{
+  mat4 view;
+  mat4 projection;
+  mat4 inverse_view_projection;
+  vec4 render_origin; // 渲染原点（路径坐标），view 作用于减去它之后的坐标
+};
+
+out vec3 NearPoint; // 视线在近平面上的点（渲染原点的相对坐标）
+out vec3 FarPoint;  // 视线在远平面上的点
+
+vec3 unproject(vec2 ndc, float depth)
+{
+  vec4 point = inverse_view_projection * vec4(ndc, depth, 1.0f);
+  return point.xyz / point.w;
+}
+
+void main()
+{
+  vec2 ndc = vec2((gl_VertexID & 1) * 4 - 1, (gl_VertexID >> 1) * 4 - 1);
+  NearPoint = unproject(ndc, -1.0f);
+  FarPoint = unproject(ndc, 1.0f);
+  gl_Position = vec4(ndc, 0.0f, 1.0f);
+}
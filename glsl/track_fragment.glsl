@@ -0,0 +1,20 @@
+#version 330 core
+out vec4 FragColor;
+
+in float LateralCoord;
+
+uniform float LaneWidth;
+
+const float kEdgeWidth = 0.15f;                        // 边线宽度（米）
+const vec3 kSurfaceColor = vec3(0.22f, 0.22f, 0.25f); // 路面
+const vec3 kLeftColor = vec3(1.0f, 0.0f, 0.0f);       // 左侧边线（红色）
+const vec3 kRightColor = vec3(0.0f, 1.0f, 1.0f);      // 右侧边线（青色）
+
+void main() {
+  // 到较近一侧边界的距离（米）
+  float edge_distance = (1.0f - abs(LateralCoord)) * LaneWidth;
+  vec3 edge_color = LateralCoord < 0.0f ? kLeftColor : kRightColor;
+  // 远处至少保留约一个像素宽，避免边线断续
+  float edge_width = max(kEdgeWidth, fwidth(edge_distance) * 1.5f);
+  FragColor = vec4(edge_distance < edge_width ? edge_color : kSurfaceColor, 1.0f);
+}
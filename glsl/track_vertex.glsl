@@ -0,0 +1,30 @@
+#version 330 core
+
+// 路面由中心线挤出：第 i 个点生成顶点 2i（左边界）和 2i+1（右边界），
+// 整块路面是一条三角形带，不需要顶点属性
+uniform samplerBuffer Centerline; // 每个点一个 texel：(x, z, 右侧法向 x, 右侧法向 z)
+
+layout( std140 ) uniform Camera
+{
+  mat4 view;
+  mat4 projection;
+  mat4 inverse_view_projection;
+  vec4 render_origin; // 渲染原点（路径坐标），view 作用于减去它之后的坐标
+};
+
+uniform float LaneWidth; // 车道宽度，拖动滑块只改这个值
+
+out float LateralCoord; // 横向坐标，-1 左边界，1 右边界
+
+void main()
+{
+  vec4 point = texelFetch(Centerline, gl_VertexID >> 1);
+  float side = (gl_VertexID & 1) == 0 ? -1.0f : 1.0f;
+
+  // 稍微抬高避免与地面重叠
+  // 中心线先减去渲染原点，分块数据保持路径坐标，原点移动时不用重传
+  vec2 center = point.xy - render_origin.xz;
+  vec3 position = vec3(center.x, 0.02f, center.y) + vec3(point.z, 0.0f, point.w) * (LaneWidth * side);
+  LateralCoord = side;
+  gl_Position = projection * (view * vec4(position, 1.0f));
+}
@@ -2,11 +2,19 @@
 
 layout( location = 0 ) in vec3 aPos;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// 每帧的摄像机矩阵，由 Core::begin_frame 写入UBO
+layout( std140 ) uniform Camera
+{
+  mat4 view;
+  mat4 projection;
+  mat4 inverse_view_projection;
+  vec4 render_origin; // 渲染原点（路径坐标），view 作用于减去它之后的坐标
+};
+
+uniform mat4 model; // 变换到渲染原点的相对坐标，由 CPU 减去原点
 
 void main() 
 {
-  gl_Position = projection * view * model * vec4(aPos, 1.0f);
-}
\ No newline at end of file
+  // 按从右到左的顺序相乘，避免先算出带大平移量的矩阵乘积
+  gl_Position = projection * (view * (model * vec4(aPos, 1.0f)));
+}
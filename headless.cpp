@@ -0,0 +1,113 @@
+#include "headless.h"
+#include "fleet.h"
+#include "simulation.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+int run_headless(const HeadlessOptions &options)
+{
+  if (options.duration <= 0.0 || options.step_rate <= 0.0f || options.speed < 0.0)
+  {
+    std::cout << "ERROR::HEADLESS::INVALID_OPTIONS: duration and rate must be positive, speed must not be negative"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Simulation simulation;
+  simulation.init_predefined_path();
+  if (!options.path_file.empty() && !simulation.load_path_file(options.path_file))
+  {
+    return EXIT_FAILURE;
+  }
+  simulation.set_loop_play(options.loop_play);
+  simulation.set_step_rate(options.step_rate);
+  simulation.start_path_playback();
+
+  TaskPool task_pool;
+  Fleet fleet;
+  fleet.set_path(simulation.path());
+  fleet.populate(options.fleet_size);
+
+  const double fixed_dt = 1.0 / options.step_rate; // 与 Simulation::advance 一样用双精度步长
+  const long long total_steps = (long long)std::ceil(options.duration * options.step_rate);
+
+  using clock = std::chrono::steady_clock;
+  const clock::time_point wall_start = clock::now();
+
+  clock::duration fleet_time = clock::duration::zero();
+  long long steps = 0;
+  for (; steps < total_steps; steps++)
+  {
+    // 非循环播放时到达终点即结束
+    if (!simulation.is_playing())
+    {
+      break;
+    }
+
+    simulation.step(fixed_dt);
+
+    if (fleet.size() > 0)
+    {
+      const clock::time_point fleet_start = clock::now();
+      fleet.step(fixed_dt, task_pool);
+      fleet_time += clock::now() - fleet_start;
+    }
+
+    // 限速模式：仿真时间按倍速对齐墙钟
+    if (options.speed > 0.0)
+    {
+      double sim_elapsed = (double)(steps + 1) * fixed_dt;
+      std::this_thread::sleep_until(wall_start + std::chrono::duration_cast<clock::duration>(
+                                                     std::chrono::duration<double>(sim_elapsed / options.speed)));
+    }
+  }
+
+  const double wall_seconds = std::chrono::duration<double>(clock::now() - wall_start).count();
+  const double sim_seconds = (double)steps * fixed_dt;
+  const double fleet_seconds = std::chrono::duration<double>(fleet_time).count();
+  const double vehicle_steps = (double)steps * (double)fleet.size();
+
+  std::ofstream output_file;
+  if (!options.output_path.empty())
+  {
+    output_file.open(options.output_path);
+    if (!output_file)
+    {
+      std::cout << "ERROR::HEADLESS::OUTPUT_NOT_WRITABLE: " << options.output_path << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream &out = output_file.is_open() ? output_file : std::cout;
+
+  const glm::vec3 &position = simulation.position();
+  out << "{\n"
+      << "  \"final_state\": {\n"
+      << "    \"playing\": " << (simulation.is_playing() ? "true" : "false") << ",\n"
+      << "    \"play_time\": " << simulation.play_time() << ",\n"
+      << "    \"path_index\": " << simulation.current_path_index() << ",\n"
+      << "    \"position\": [" << position.x << ", " << position.y << ", " << position.z << "],\n"
+      << "    \"yaw\": " << simulation.yaw_angle() << ",\n"
+      << "    \"traveled_points\": " << simulation.traveled_path().size() << "\n"
+      << "  },\n"
+      << "  \"timing\": {\n"
+      << "    \"steps\": " << steps << ",\n"
+      << "    \"step_rate\": " << options.step_rate << ",\n"
+      << "    \"sim_seconds\": " << sim_seconds << ",\n"
+      << "    \"wall_seconds\": " << wall_seconds << ",\n"
+      << "    \"sim_per_wall\": " << (wall_seconds > 0.0 ? sim_seconds / wall_seconds : 0.0) << ",\n"
+      << "    \"ns_per_step\": " << (steps > 0 ? wall_seconds * 1e9 / steps : 0.0) << "\n"
+      << "  },\n"
+      << "  \"fleet\": {\n"
+      << "    \"vehicles\": " << fleet.size() << ",\n"
+      << "    \"threads\": " << task_pool.concurrency() << ",\n"
+      << "    \"update_seconds\": " << fleet_seconds << ",\n"
+      << "    \"ns_per_vehicle_step\": " << (vehicle_steps > 0.0 ? fleet_seconds * 1e9 / vehicle_steps : 0.0) << "\n"
+      << "  }\n"
+      << "}" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,21 @@
+#ifndef __HEADLESS_H
+#define __HEADLESS_H
+#include <cstddef>
+#include <string>
+
+// 无界面批量播放参数
+struct HeadlessOptions
+{
+  double duration = 120.0;  // 仿真时长（秒）
+  double speed = 0.0;       // 相对墙钟的倍速，0 表示不限速（--speed max）
+  float step_rate = 120.0f; // 仿真频率（Hz）
+  bool loop_play = true;    // 是否循环播放
+  size_t fleet_size = 0;    // 同时仿真的车队规模，0 表示只仿真单车
+  std::string path_file;    // 二进制路径文件，为空时使用预定义路径
+  std::string output_path;  // 结果输出文件，为空时输出到标准输出
+};
+
+// 在没有窗口和GL上下文的情况下运行路径播放，结束后写出最终状态和耗时统计
+int run_headless(const HeadlessOptions &options);
+
+#endif
@@ -0,0 +1,283 @@
+#include "interpolation.h"
+#include <algorithm>
+#include <cstddef>
+
+// SIMD 版本只在 x86-64 上编译（SSE2 是基线指令集），其他平台只有标量版本
+#if defined(__x86_64__) || defined(_M_X64)
+#define INTERPOLATION_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// AVX2 版本单独指定目标指令集，整个程序不需要 -mavx2，运行时检测通过后才会调用
+#if defined(__GNUC__) || defined(__clang__)
+#define INTERPOLATION_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define INTERPOLATION_TARGET_AVX2
+#endif
+
+// 路径点按 float 计的跨度，以及 x、y、z、yaw 在路径点中的位置；SIMD 版本按这个跨度从路径点数组中收集
+static const int kPointStride = (int)(sizeof(PathPoint) / sizeof(float));
+static const int kFieldX = 0;
+static const int kFieldY = 1;
+static const int kFieldZ = 2;
+static const int kFieldYaw = 3;
+static_assert(sizeof(PathPoint) % sizeof(float) == 0, "PathPoint must be a whole number of floats");
+static_assert(offsetof(PathPoint, yaw) == kFieldYaw * sizeof(float), "yaw must follow the position");
+
+// 标量版本：参数带 __restrict（GCC 只对函数参数做这项别名分析），循环可被自动向量化
+static void interpolate_scalar(const PathPoint *__restrict points, const float *__restrict progress,
+                               const int *__restrict indices, const float *__restrict lateral_offsets,
+                               float *__restrict position_x, float *__restrict position_y,
+                               float *__restrict position_z, float *__restrict yaws, size_t begin, size_t end)
+{
+  for (size_t i = begin; i < end; i++)
+  {
+    const PathPoint &p0 = points[indices[i]];
+    const PathPoint &p1 = points[indices[i] + 1];
+    const float t = progress[i];
+
+    float yaw = wrap_degrees(p0.yaw + shortest_yaw_delta(p0.yaw, p1.yaw) * t);
+    float lateral = lateral_offsets[i];
+
+    // 右侧法向 (-cos yaw, sin yaw)，-cos yaw 即 sin(yaw - 90)
+    position_x[i] = p0.position.x + (p1.position.x - p0.position.x) * t + sin_degrees(wrap_degrees(yaw - 90.0f)) * lateral;
+    position_y[i] = p0.position.y + (p1.position.y - p0.position.y) * t;
+    position_z[i] = p0.position.z + (p1.position.z - p0.position.z) * t + sin_degrees(yaw) * lateral;
+    yaws[i] = yaw;
+  }
+}
+
+static void interpolate_scalar(const PathView &path, const VehicleColumns &vehicles, size_t begin, size_t end)
+{
+  interpolate_scalar(path.points, vehicles.progress, vehicles.indices, vehicles.lateral_offsets, vehicles.position_x,
+                     vehicles.position_y, vehicles.position_z, vehicles.yaws, begin, end);
+}
+
+#ifdef INTERPOLATION_X86
+
+// SSE2 没有 gather 指令，逐个读取后组装成向量；base 指向某个字段，下标按路径点计
+static inline __m128 gather_sse2(const float *base, const int *indices)
+{
+  return _mm_setr_ps(base[indices[0] * kPointStride], base[indices[1] * kPointStride],
+                     base[indices[2] * kPointStride], base[indices[3] * kPointStride]);
+}
+
+static inline __m128 lerp_sse2(__m128 a, __m128 b, __m128 t)
+{
+  return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+
+// cvtps 按默认的就近舍入取整；与标量版本只在正好半圈时取舍不同，两者都表示同一朝向
+static inline __m128 wrap_degrees_sse2(__m128 angle)
+{
+  __m128 turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(angle, _mm_set1_ps(1.0f / 360.0f))));
+  return _mm_sub_ps(angle, _mm_mul_ps(turns, _mm_set1_ps(360.0f)));
+}
+
+// 与 sin_degrees 相同的折叠和级数，符号位直接用位运算处理
+static inline __m128 sin_degrees_sse2(__m128 angle)
+{
+  const __m128 sign_mask = _mm_set1_ps(-0.0f);
+  __m128 sign = _mm_and_ps(angle, sign_mask);
+  __m128 magnitude = _mm_andnot_ps(sign_mask, angle);
+  magnitude = _mm_min_ps(magnitude, _mm_sub_ps(_mm_set1_ps(180.0f), magnitude));
+  __m128 x = _mm_mul_ps(_mm_or_ps(magnitude, sign), _mm_set1_ps(3.14159265f / 180.0f));
+  __m128 x2 = _mm_mul_ps(x, x);
+
+  __m128 series = _mm_set1_ps(1.0f / 362880.0f);
+  series = _mm_add_ps(_mm_mul_ps(series, x2), _mm_set1_ps(-1.0f / 5040.0f));
+  series = _mm_add_ps(_mm_mul_ps(series, x2), _mm_set1_ps(1.0f / 120.0f));
+  series = _mm_add_ps(_mm_mul_ps(series, x2), _mm_set1_ps(-1.0f / 6.0f));
+  series = _mm_add_ps(_mm_mul_ps(series, x2), _mm_set1_ps(1.0f));
+  return _mm_mul_ps(x, series);
+}
+
+static void interpolate_sse2(const PathView &path, const VehicleColumns &vehicles, size_t begin, size_t end)
+{
+  const float *base = reinterpret_cast<const float *>(path.points);
+
+  size_t i = begin;
+  for (; i + 4 <= end; i += 4)
+  {
+    const int *i0 = vehicles.indices + i;
+    __m128 t = _mm_loadu_ps(vehicles.progress + i);
+
+    // 下一个路径点的值通过基址加一个路径点的跨度收集
+    __m128 yaw0 = gather_sse2(base + kFieldYaw, i0);
+    __m128 diff = wrap_degrees_sse2(_mm_sub_ps(gather_sse2(base + kPointStride + kFieldYaw, i0), yaw0));
+    __m128 yaw = wrap_degrees_sse2(_mm_add_ps(yaw0, _mm_mul_ps(diff, t)));
+    _mm_storeu_ps(vehicles.yaws + i, yaw);
+
+    __m128 lateral = _mm_loadu_ps(vehicles.lateral_offsets + i);
+    __m128 nx = sin_degrees_sse2(wrap_degrees_sse2(_mm_sub_ps(yaw, _mm_set1_ps(90.0f))));
+    __m128 nz = sin_degrees_sse2(yaw);
+
+    __m128 x = lerp_sse2(gather_sse2(base + kFieldX, i0), gather_sse2(base + kPointStride + kFieldX, i0), t);
+    __m128 y = lerp_sse2(gather_sse2(base + kFieldY, i0), gather_sse2(base + kPointStride + kFieldY, i0), t);
+    __m128 z = lerp_sse2(gather_sse2(base + kFieldZ, i0), gather_sse2(base + kPointStride + kFieldZ, i0), t);
+    _mm_storeu_ps(vehicles.position_x + i, _mm_add_ps(x, _mm_mul_ps(nx, lateral)));
+    _mm_storeu_ps(vehicles.position_y + i, y);
+    _mm_storeu_ps(vehicles.position_z + i, _mm_add_ps(z, _mm_mul_ps(nz, lateral)));
+  }
+
+  // 不足一个向量的尾部
+  interpolate_scalar(path, vehicles, i, end);
+}
+
+// 下标乘 3、比例取 8，得到按 24 字节路径点计的字节偏移；路径点数不超过 7 亿时不会溢出
+INTERPOLATION_TARGET_AVX2 static inline __m256 gather_avx2(const float *base, __m256i offsets)
+{
+  return _mm256_i32gather_ps(base, offsets, 8);
+}
+
+INTERPOLATION_TARGET_AVX2 static inline __m256 lerp_avx2(__m256 a, __m256 b, __m256 t)
+{
+  return _mm256_fmadd_ps(_mm256_sub_ps(b, a), t, a);
+}
+
+INTERPOLATION_TARGET_AVX2 static inline __m256 wrap_degrees_avx2(__m256 angle)
+{
+  __m256 turns = _mm256_round_ps(_mm256_mul_ps(angle, _mm256_set1_ps(1.0f / 360.0f)),
+                                 _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  return _mm256_fnmadd_ps(turns, _mm256_set1_ps(360.0f), angle);
+}
+
+INTERPOLATION_TARGET_AVX2 static inline __m256 sin_degrees_avx2(__m256 angle)
+{
+  const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+  __m256 sign = _mm256_and_ps(angle, sign_mask);
+  __m256 magnitude = _mm256_andnot_ps(sign_mask, angle);
+  magnitude = _mm256_min_ps(magnitude, _mm256_sub_ps(_mm256_set1_ps(180.0f), magnitude));
+  __m256 x = _mm256_mul_ps(_mm256_or_ps(magnitude, sign), _mm256_set1_ps(3.14159265f / 180.0f));
+  __m256 x2 = _mm256_mul_ps(x, x);
+
+  __m256 series = _mm256_set1_ps(1.0f / 362880.0f);
+  series = _mm256_fmadd_ps(series, x2, _mm256_set1_ps(-1.0f / 5040.0f));
+  series = _mm256_fmadd_ps(series, x2, _mm256_set1_ps(1.0f / 120.0f));
+  series = _mm256_fmadd_ps(series, x2, _mm256_set1_ps(-1.0f / 6.0f));
+  series = _mm256_fmadd_ps(series, x2, _mm256_set1_ps(1.0f));
+  return _mm256_mul_ps(x, series);
+}
+
+INTERPOLATION_TARGET_AVX2 static void interpolate_avx2(const PathView &path, const VehicleColumns &vehicles,
+                                                       size_t begin, size_t end)
+{
+  static_assert(sizeof(PathPoint) == 24, "the AVX2 gather scales indices by 3 * 8 bytes");
+  const float *base = reinterpret_cast<const float *>(path.points);
+
+  size_t i = begin;
+  for (; i + 8 <= end; i += 8)
+  {
+    const __m256i i0 = _mm256_loadu_si256((const __m256i *)(vehicles.indices + i));
+    const __m256i offsets = _mm256_add_epi32(_mm256_add_epi32(i0, i0), i0);
+    __m256 t = _mm256_loadu_ps(vehicles.progress + i);
+
+    __m256 yaw0 = gather_avx2(base + kFieldYaw, offsets);
+    __m256 diff = wrap_degrees_avx2(_mm256_sub_ps(gather_avx2(base + kPointStride + kFieldYaw, offsets), yaw0));
+    __m256 yaw = wrap_degrees_avx2(_mm256_fmadd_ps(diff, t, yaw0));
+    _mm256_storeu_ps(vehicles.yaws + i, yaw);
+
+    __m256 lateral = _mm256_loadu_ps(vehicles.lateral_offsets + i);
+    __m256 nx = sin_degrees_avx2(wrap_degrees_avx2(_mm256_sub_ps(yaw, _mm256_set1_ps(90.0f))));
+    __m256 nz = sin_degrees_avx2(yaw);
+
+    __m256 x = lerp_avx2(gather_avx2(base + kFieldX, offsets), gather_avx2(base + kPointStride + kFieldX, offsets), t);
+    __m256 y = lerp_avx2(gather_avx2(base + kFieldY, offsets), gather_avx2(base + kPointStride + kFieldY, offsets), t);
+    __m256 z = lerp_avx2(gather_avx2(base + kFieldZ, offsets), gather_avx2(base + kPointStride + kFieldZ, offsets), t);
+    _mm256_storeu_ps(vehicles.position_x + i, _mm256_fmadd_ps(nx, lateral, x));
+    _mm256_storeu_ps(vehicles.position_y + i, y);
+    _mm256_storeu_ps(vehicles.position_z + i, _mm256_fmadd_ps(nz, lateral, z));
+  }
+
+  interpolate_scalar(path, vehicles, i, end);
+}
+
+static bool cpu_supports_avx2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+  {
+    return false;
+  }
+
+  // 还要确认操作系统保存了 YMM 寄存器
+  __cpuid(info, 1);
+  bool fma = (info[2] & (1 << 12)) != 0;
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  if (!fma || !osxsave || (_xgetbv(0) & 6) != 6)
+  {
+    return false;
+  }
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return false;
+#endif
+}
+
+#endif
+
+SimdLevel detect_simd_level()
+{
+#ifdef INTERPOLATION_X86
+  return cpu_supports_avx2() ? SimdLevel::AVX2 : SimdLevel::SSE2;
+#else
+  return SimdLevel::Scalar;
+#endif
+}
+
+bool simd_level_supported(SimdLevel level)
+{
+  return level <= detect_simd_level();
+}
+
+const char *simd_level_name(SimdLevel level)
+{
+  switch (level)
+  {
+  case SimdLevel::SSE2:
+    return "sse2";
+  case SimdLevel::AVX2:
+    return "avx2";
+  default:
+    return "scalar";
+  }
+}
+
+void interpolate_batch(const PathView &path, const VehicleColumns &vehicles, size_t begin, size_t end)
+{
+  // 只检测一次
+  static const SimdLevel level = detect_simd_level();
+  interpolate_batch(level, path, vehicles, begin, end);
+}
+
+void interpolate_batch(SimdLevel level, const PathView &path, const VehicleColumns &vehicles, size_t begin, size_t end)
+{
+  if (begin >= end)
+  {
+    return;
+  }
+
+#ifdef INTERPOLATION_X86
+  if (level == SimdLevel::AVX2)
+  {
+    interpolate_avx2(path, vehicles, begin, end);
+    return;
+  }
+  if (level == SimdLevel::SSE2)
+  {
+    interpolate_sse2(path, vehicles, begin, end);
+    return;
+  }
+#endif
+  interpolate_scalar(path, vehicles, begin, end);
+}
@@ -0,0 +1,63 @@
+#ifndef __INTERPOLATION_H
+#define __INTERPOLATION_H
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "path_view.h"
+
+// 角度规整到 [-180, 180]，不使用循环
+// 四舍五入用截断实现（没有 SSE4.1 时 nearbyint/floor 都是函数调用），可被自动向量化
+inline float wrap_degrees(float angle)
+{
+  float turns = angle * (1.0f / 360.0f);
+  return angle - 360.0f * (float)(int)(turns + std::copysign(0.5f, turns));
+}
+
+// 从 from 转到 to 的最短角度差
+inline float shortest_yaw_delta(float from, float to)
+{
+  return wrap_degrees(to - from);
+}
+
+// 角度（度）的正弦，输入须在 [-180, 180] 内。先折到 [-90, 90]，再用到 9 次项的泰勒级数，误差小于 4e-6；
+// 没有分支和库函数调用，可被自动向量化
+inline float sin_degrees(float angle)
+{
+  float magnitude = std::min(std::abs(angle), 180.0f - std::abs(angle));
+  float x = std::copysign(magnitude, angle) * (3.14159265f / 180.0f);
+  float x2 = x * x;
+  return x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f)))));
+}
+
+// 批量插值使用的指令集
+enum class SimdLevel
+{
+  Scalar, // 纯 C++，由编译器自动向量化（非 x86 平台只有这一档）
+  SSE2,   // x86-64 基线指令集
+  AVX2,   // 运行时检测到 AVX2 和 FMA 时使用，gather 指令收集路径点
+};
+
+// 车辆数据（按列存放，下标为车辆）
+struct VehicleColumns
+{
+  const float *progress; // 所在路径段内的进度，在 [0, 1] 内
+  const int *indices;    // 所在路径段，必须小于路径点数减一
+  const float *lateral_offsets;
+  float *position_x;
+  float *position_y;
+  float *position_z;
+  float *yaws;
+};
+
+SimdLevel detect_simd_level(); // 当前 CPU 支持的最高一档
+bool simd_level_supported(SimdLevel level);
+const char *simd_level_name(SimdLevel level);
+
+// 对 [begin, end) 内的车辆按所在路径段插值位置和最短弧偏航角，车道偏移沿插值后朝向的右侧法向 (-cos yaw, sin yaw)。
+// 路径点直接从 PathView 读取（可以是映射的路径文件），不需要按列拷贝
+// 不指定指令集时使用 detect_simd_level() 的结果；指定时必须是 simd_level_supported() 的一档
+void interpolate_batch(const PathView &path, const VehicleColumns &vehicles, size_t begin, size_t end);
+void interpolate_batch(SimdLevel level, const PathView &path, const VehicleColumns &vehicles, size_t begin, size_t end);
+
+#endif
@@ -1,8 +1,214 @@
 #include "app.h"
-int main()
+#include "headless.h"
+#include "offscreen.h"
+#include "path_file.h"
+#include "path_import.h"
+#include "simulation.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// 在作用域内把 std::cout 改写到标准错误，析构时恢复
+struct StdoutToStderr
 {
+  std::streambuf *saved = nullptr;
+
+  void redirect()
+  {
+    saved = std::cout.rdbuf(std::cerr.rdbuf());
+  }
+  ~StdoutToStderr()
+  {
+    if (saved != nullptr)
+    {
+      std::cout.rdbuf(saved);
+    }
+  }
+};
+
+static void print_usage(const char *program)
+{
+  std::cout << "Usage: " << program << " [--headless] [--duration <秒>] [--speed <倍速|max>]\n"
+            << "       [--rate <Hz>] [--no-loop] [--fleet <车辆数>] [--output <文件>]\n"
+            << "       [--path <路径文件>] [--export-path <路径文件>] [--import <CSV/NDJSON>]\n"
+            << "       [--offscreen] [--width <像素>] [--height <像素>] [--fps <帧率>]\n"
+            << "       [--capture <目录>] [--capture-y4m <文件|->] [--profile <文件>]\n"
+            << "       [--near <米>] [--far <米>]\n"
+            << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+  bool headless = false;
+  bool offscreen = false;
+  HeadlessOptions options;
+  OffscreenOptions offscreen_options; // 时长、循环、车队、路径、输出文件和仿真频率与无界面模式共用同名参数
+  bool unlimited_speed = false;       // --speed max 只对无界面模式有意义
+  std::string export_path;
+  std::string import_path;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    bool has_value = i + 1 < argc;
+
+    if (strcmp(arg, "--headless") == 0)
+    {
+      headless = true;
+    }
+    else if (strcmp(arg, "--offscreen") == 0)
+    {
+      offscreen = true;
+    }
+    else if (strcmp(arg, "--duration") == 0 && has_value)
+    {
+      options.duration = offscreen_options.duration = atof(argv[++i]);
+    }
+    else if (strcmp(arg, "--speed") == 0 && has_value)
+    {
+      // 无界面模式下是相对墙钟的倍速，离屏渲染和图形界面下是播放速度倍率
+      const char *value = argv[++i];
+      unlimited_speed = strcmp(value, "max") == 0;
+      options.speed = unlimited_speed ? 0.0 : atof(value);
+      offscreen_options.play_speed = unlimited_speed ? 1.0f : (float)atof(value);
+    }
+    else if (strcmp(arg, "--rate") == 0 && has_value)
+    {
+      options.step_rate = offscreen_options.step_rate = (float)atof(argv[++i]);
+    }
+    else if (strcmp(arg, "--no-loop") == 0)
+    {
+      options.loop_play = offscreen_options.loop_play = false;
+    }
+    else if (strcmp(arg, "--fleet") == 0 && has_value)
+    {
+      options.fleet_size = offscreen_options.fleet_size = (size_t)atol(argv[++i]);
+    }
+    else if (strcmp(arg, "--path") == 0 && has_value)
+    {
+      options.path_file = offscreen_options.path_file = argv[++i];
+    }
+    else if (strcmp(arg, "--export-path") == 0 && has_value)
+    {
+      export_path = argv[++i];
+    }
+    else if (strcmp(arg, "--import") == 0 && has_value)
+    {
+      import_path = argv[++i];
+    }
+    else if (strcmp(arg, "--output") == 0 && has_value)
+    {
+      options.output_path = offscreen_options.output_path = argv[++i];
+    }
+    else if (strcmp(arg, "--width") == 0 && has_value)
+    {
+      offscreen_options.width = atoi(argv[++i]);
+    }
+    else if (strcmp(arg, "--height") == 0 && has_value)
+    {
+      offscreen_options.height = atoi(argv[++i]);
+    }
+    else if (strcmp(arg, "--fps") == 0 && has_value)
+    {
+      offscreen_options.fps = atof(argv[++i]);
+    }
+    else if (strcmp(arg, "--capture") == 0 && has_value)
+    {
+      offscreen_options.capture_format = CaptureFormat::kPngSequence;
+      offscreen_options.capture_path = argv[++i];
+    }
+    else if (strcmp(arg, "--capture-y4m") == 0 && has_value)
+    {
+      offscreen_options.capture_format = CaptureFormat::kY4m;
+      offscreen_options.capture_path = argv[++i];
+    }
+    else if (strcmp(arg, "--profile") == 0 && has_value)
+    {
+      offscreen_options.profile_path = argv[++i];
+    }
+    else if (strcmp(arg, "--near") == 0 && has_value)
+    {
+      offscreen_options.near_plane = (float)atof(argv[++i]);
+    }
+    else if (strcmp(arg, "--far") == 0 && has_value)
+    {
+      offscreen_options.far_plane = (float)atof(argv[++i]);
+    }
+    else
+    {
+      print_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  // 视频流写到标准输出时，运行期间的诊断信息（路径加载、着色器、录制错误等）都改到标准错误
+  StdoutToStderr diagnostics_redirect;
+  if (offscreen_options.capture_path == "-")
+  {
+    diagnostics_redirect.redirect();
+  }
+
+  // 导入行驶记录，转换成 --export-path 指定的二进制路径文件
+  if (!import_path.empty())
+  {
+    if (export_path.empty())
+    {
+      print_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    return import_path_file(import_path, export_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  // 把预定义路径导出为二进制路径文件
+  if (!export_path.empty())
+  {
+    Simulation simulation;
+    simulation.init_predefined_path();
+    return write_path_file(export_path, simulation.path()) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  // 倍速必须为正（无法解析的值按 0 处理），不限速只能显式写 max
+  if (!unlimited_speed && offscreen_options.play_speed <= 0.0f)
+  {
+    std::cout << "ERROR::MAIN::INVALID_OPTIONS: speed must be positive or max" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (headless)
+  {
+    return run_headless(options);
+  }
+
+  // 离屏渲染和图形界面按渲染帧推进，没有"不限速"
+  if (unlimited_speed)
+  {
+    std::cout << "ERROR::MAIN::INVALID_SPEED: --speed max is only supported with --headless" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (offscreen_options.step_rate <= 0.0f)
+  {
+    std::cout << "ERROR::MAIN::INVALID_OPTIONS: speed and rate must be positive" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (offscreen)
+  {
+    return run_offscreen(offscreen_options);
+  }
+
   App app("spatial_plane_simulation", 1280, 800);
+  app.set_clip_planes(offscreen_options.near_plane, offscreen_options.far_plane);
+  app.set_playback(offscreen_options.play_speed, offscreen_options.step_rate);
+  // 加载失败时已输出错误，继续使用预定义路径
+  if (!options.path_file.empty())
+  {
+    app.load_path_file(options.path_file);
+  }
+  if (!offscreen_options.capture_path.empty())
+  {
+    app.set_capture(offscreen_options.capture_format, offscreen_options.capture_path);
+  }
   app.app_run();
   app.app_exit();
   return 0;
-}
\ No newline at end of file
+}
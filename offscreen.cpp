@@ -0,0 +1,141 @@
+#include "offscreen.h"
+#include "core.h"
+#include "offscreen_context.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+int run_offscreen(const OffscreenOptions &options)
+{
+  if (options.duration <= 0.0 || options.fps <= 0.0 || options.width <= 0 || options.height <= 0 ||
+      options.play_speed <= 0.0f || options.step_rate <= 0.0f)
+  {
+    std::cout << "ERROR::OFFSCREEN::INVALID_OPTIONS: duration, fps, size, speed and rate must be positive" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  OffscreenContext context;
+  if (!context.create(options.width, options.height))
+  {
+    return EXIT_FAILURE;
+  }
+
+  long long frames = 0;
+  double sim_seconds = 0.0;
+  double wall_seconds = 0.0;
+  double render_seconds = 0.0;
+  size_t captured_frames = 0;
+  size_t dropped_frames = 0;
+  {
+    // Core 持有 GL 对象，必须在上下文销毁前析构
+    Core core;
+    core.init_core();
+    if (!options.path_file.empty() && !core.load_path_file(options.path_file))
+    {
+      return EXIT_FAILURE;
+    }
+    core.set_fleet_size((int)options.fleet_size);
+    core.set_clip_planes(options.near_plane, options.far_plane);
+
+    Simulation &simulation = core.simulation();
+    simulation.set_loop_play(options.loop_play);
+    simulation.set_play_speed(options.play_speed);
+    simulation.set_step_rate(options.step_rate);
+    simulation.start_path_playback();
+
+    // 离屏渲染与墙钟无关，录制时等待读回和编码，不丢帧；读回仍与后续几帧的渲染重叠
+    FrameCapture capture;
+    capture.set_lossless(true);
+    if (!options.capture_path.empty() &&
+        !capture.open(options.capture_format, options.capture_path, options.width, options.height, options.fps))
+    {
+      return EXIT_FAILURE;
+    }
+
+    // 每帧固定推进 frame_dt，不会卡顿，取消单帧上限；否则 fps 低于 4 时每帧只推进 0.25 秒
+    const double frame_dt = 1.0 / options.fps;
+    simulation.set_max_frame_time(frame_dt);
+    const long long total_frames = (long long)std::ceil(options.duration * options.fps);
+
+    using clock = std::chrono::steady_clock;
+    const clock::time_point wall_start = clock::now();
+    clock::duration render_time = clock::duration::zero();
+
+    for (; frames < total_frames; frames++)
+    {
+      // 非循环播放时到达终点即结束
+      if (!simulation.is_playing())
+      {
+        break;
+      }
+
+      core.profiler().begin_frame();
+      {
+        ProfileScope scope(core.profiler(), "update");
+        core.update(frame_dt);
+      }
+
+      // 只计提交渲染命令的 CPU 时间，GPU 耗时见 --profile
+      const clock::time_point render_start = clock::now();
+      context.bind_framebuffer();
+      glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+      glClear(GL_COLOR_BUFFER_BIT);
+      core.begin_frame(options.width, options.height);
+      core.render_scene();
+      render_time += clock::now() - render_start;
+
+      {
+        ProfileScope scope(core.profiler(), "capture");
+        capture.capture();
+      }
+    }
+
+    const bool capture_ok = capture.close();
+    glFinish();
+    sim_seconds = simulation.clock().elapsed();
+    wall_seconds = std::chrono::duration<double>(clock::now() - wall_start).count();
+    render_seconds = std::chrono::duration<double>(render_time).count();
+    captured_frames = capture.written();
+    dropped_frames = capture.dropped();
+    if (!capture_ok)
+    {
+      return EXIT_FAILURE;
+    }
+
+    if (!options.profile_path.empty() && !core.profiler().write_json(options.profile_path))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::ofstream output_file;
+  if (!options.output_path.empty())
+  {
+    output_file.open(options.output_path);
+    if (!output_file)
+    {
+      std::cout << "ERROR::OFFSCREEN::OUTPUT_NOT_WRITABLE: " << options.output_path << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  // Y4M 写到标准输出时统计改写到标准错误
+  std::ostream &out = output_file.is_open() ? output_file : options.capture_path == "-" ? std::cerr : std::cout;
+
+  out << "{\n"
+      << "  \"renderer\": \"" << context.renderer() << "\",\n"
+      << "  \"width\": " << options.width << ",\n"
+      << "  \"height\": " << options.height << ",\n"
+      << "  \"fps\": " << options.fps << ",\n"
+      << "  \"frames\": " << frames << ",\n"
+      << "  \"sim_seconds\": " << sim_seconds << ",\n"
+      << "  \"wall_seconds\": " << wall_seconds << ",\n"
+      << "  \"ms_per_frame\": " << (frames > 0 ? wall_seconds * 1e3 / frames : 0.0) << ",\n"
+      << "  \"render_ms_per_frame\": " << (frames > 0 ? render_seconds * 1e3 / frames : 0.0) << ",\n"
+      << "  \"captured_frames\": " << captured_frames << ",\n"
+      << "  \"dropped_frames\": " << dropped_frames << "\n"
+      << "}" << std::endl;
+
+  return EXIT_SUCCESS;
+}
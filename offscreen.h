@@ -0,0 +1,32 @@
+#ifndef __OFFSCREEN_H
+#define __OFFSCREEN_H
+#include <cstddef>
+#include <string>
+
+#include "frame_capture.h"
+
+// 离屏渲染参数
+struct OffscreenOptions
+{
+  int width = 1280;          // 帧缓冲分辨率
+  int height = 800;
+  double fps = 60.0;         // 每帧推进 1/fps 秒仿真时间，与实际渲染快慢无关
+  double duration = 10.0;    // 仿真时长（秒）
+  float near_plane = 0.1f;   // 投影的近平面和远平面（米）
+  float far_plane = 100.0f;
+  float play_speed = 1.0f;   // 播放速度倍率（--speed）
+  float step_rate = 120.0f;  // 仿真频率（Hz），每帧按这个步长推进
+  bool loop_play = true;     // 是否循环播放
+  size_t fleet_size = 0;     // 车队规模
+  std::string path_file;     // 二进制路径文件，为空时使用预定义路径
+  std::string capture_path;  // 录制输出：PNG 序列的目录，或 Y4M 文件（"-" 为标准输出），为空时不录制
+  CaptureFormat capture_format = CaptureFormat::kPngSequence;
+  std::string output_path;   // 统计结果输出文件，为空时输出到标准输出
+  std::string profile_path;  // 各渲染流程的帧耗时统计（JSON），为空时不导出
+};
+
+// 不创建窗口，通过 EGL 离屏上下文把与图形界面相同的渲染流程画到帧缓冲对象中。
+// 没有显示器和 GPU 的机器上由 Mesa llvmpipe 软件渲染，结束后输出帧数和耗时统计
+int run_offscreen(const OffscreenOptions &options);
+
+#endif
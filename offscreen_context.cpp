@@ -0,0 +1,208 @@
+#include "offscreen_context.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#include <iostream>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+static bool has_extension(const char *extensions, const char *name)
+{
+  if (extensions == nullptr)
+  {
+    return false;
+  }
+
+  // 扩展名以空格分隔，避免前缀误匹配
+  const size_t length = strlen(name);
+  for (const char *p = strstr(extensions, name); p != nullptr; p = strstr(p + length, name))
+  {
+    if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0'))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+OffscreenContext::~OffscreenContext()
+{
+  destroy();
+}
+
+bool OffscreenContext::create(int width, int height)
+{
+  destroy();
+  if (width <= 0 || height <= 0)
+  {
+    std::cout << "ERROR::OFFSCREEN::INVALID_SIZE: " << width << "x" << height << std::endl;
+    return false;
+  }
+
+  // 有 surfaceless 平台时不需要任何显示服务器，否则退回默认显示
+  EGLDisplay display = EGL_NO_DISPLAY;
+  const char *client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  if (has_extension(client_extensions, "EGL_MESA_platform_surfaceless"))
+  {
+    auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display != nullptr)
+    {
+      display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+  }
+  if (display == EGL_NO_DISPLAY)
+  {
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  }
+
+  EGLint major = 0, minor = 0;
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+  {
+    std::cout << "ERROR::OFFSCREEN::EGL_INITIALIZE_FAILED: 0x" << std::hex << eglGetError() << std::dec << std::endl;
+    return false;
+  }
+  display_ = display;
+
+  if (!eglBindAPI(EGL_OPENGL_API))
+  {
+    std::cout << "ERROR::OFFSCREEN::OPENGL_API_UNAVAILABLE" << std::endl;
+    destroy();
+    return false;
+  }
+
+  // 颜色缓冲在帧缓冲对象上，配置只用来创建上下文
+  const bool surfaceless = has_extension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+  const EGLint config_attributes[] = {
+      EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_RED_SIZE, 8,
+      EGL_GREEN_SIZE, 8,
+      EGL_BLUE_SIZE, 8,
+      EGL_NONE};
+  EGLConfig config = nullptr;
+  EGLint config_count = 0;
+  if (!eglChooseConfig(display, config_attributes, &config, 1, &config_count) || config_count == 0)
+  {
+    std::cout << "ERROR::OFFSCREEN::NO_MATCHING_CONFIG" << std::endl;
+    destroy();
+    return false;
+  }
+
+  const EGLint context_attributes[] = {
+      EGL_CONTEXT_MAJOR_VERSION, 3,
+      EGL_CONTEXT_MINOR_VERSION, 3,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE};
+  context_ = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+  if (context_ == EGL_NO_CONTEXT)
+  {
+    std::cout << "ERROR::OFFSCREEN::CONTEXT_CREATION_FAILED: 0x" << std::hex << eglGetError() << std::dec << std::endl;
+    context_ = nullptr;
+    destroy();
+    return false;
+  }
+
+  if (!surfaceless)
+  {
+    const EGLint pbuffer_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+    surface_ = eglCreatePbufferSurface(display, config, pbuffer_attributes);
+    if (surface_ == EGL_NO_SURFACE)
+    {
+      std::cout << "ERROR::OFFSCREEN::PBUFFER_CREATION_FAILED: 0x" << std::hex << eglGetError() << std::dec << std::endl;
+      surface_ = nullptr;
+      destroy();
+      return false;
+    }
+  }
+
+  EGLSurface surface = surface_ != nullptr ? (EGLSurface)surface_ : EGL_NO_SURFACE;
+  if (!eglMakeCurrent(display, surface, surface, (EGLContext)context_))
+  {
+    std::cout << "ERROR::OFFSCREEN::MAKE_CURRENT_FAILED: 0x" << std::hex << eglGetError() << std::dec << std::endl;
+    destroy();
+    return false;
+  }
+
+  if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+  {
+    std::cout << "ERROR::OFFSCREEN::GLAD_LOAD_FAILED" << std::endl;
+    destroy();
+    return false;
+  }
+
+  glGenFramebuffers(1, &framebuffer_);
+  glGenRenderbuffers(1, &color_renderbuffer_);
+  glBindRenderbuffer(GL_RENDERBUFFER, color_renderbuffer_);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_renderbuffer_);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+  {
+    std::cout << "ERROR::OFFSCREEN::FRAMEBUFFER_INCOMPLETE" << std::endl;
+    destroy();
+    return false;
+  }
+
+  width_ = width;
+  height_ = height;
+  bind_framebuffer();
+  return true;
+}
+
+void OffscreenContext::destroy()
+{
+  if (display_ == nullptr)
+  {
+    return;
+  }
+
+  EGLDisplay display = (EGLDisplay)display_;
+  if (context_ != nullptr && eglGetCurrentContext() == (EGLContext)context_)
+  {
+    if (framebuffer_ != 0)
+    {
+      glDeleteFramebuffers(1, &framebuffer_);
+    }
+    if (color_renderbuffer_ != 0)
+    {
+      glDeleteRenderbuffers(1, &color_renderbuffer_);
+    }
+  }
+  framebuffer_ = 0;
+  color_renderbuffer_ = 0;
+  width_ = 0;
+  height_ = 0;
+
+  eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (surface_ != nullptr)
+  {
+    eglDestroySurface(display, (EGLSurface)surface_);
+    surface_ = nullptr;
+  }
+  if (context_ != nullptr)
+  {
+    eglDestroyContext(display, (EGLContext)context_);
+    context_ = nullptr;
+  }
+  eglTerminate(display);
+  display_ = nullptr;
+}
+
+void OffscreenContext::bind_framebuffer() const
+{
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  glViewport(0, 0, width_, height_);
+}
+
+std::string OffscreenContext::renderer() const
+{
+  if (context_ == nullptr)
+  {
+    return std::string();
+  }
+  return std::string((const char *)glGetString(GL_RENDERER)) + " / " + (const char *)glGetString(GL_VERSION);
+}
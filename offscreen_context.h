@@ -0,0 +1,36 @@
+#ifndef __OFFSCREEN_CONTEXT_H
+#define __OFFSCREEN_CONTEXT_H
+#include <glad/glad.h>
+#include <string>
+
+// 不依赖窗口系统的 GL 3.3 核心上下文：通过 EGL 创建（优先 Mesa 的 surfaceless 平台，
+// 没有显示器和 GPU 时由 llvmpipe 软件渲染），渲染目标是自带的帧缓冲对象
+class OffscreenContext
+{
+private:
+  void *display_ = nullptr; // EGLDisplay
+  void *context_ = nullptr; // EGLContext
+  void *surface_ = nullptr; // EGLSurface，驱动不支持无表面上下文时才创建的 1x1 pbuffer
+  GLuint framebuffer_ = 0;
+  GLuint color_renderbuffer_ = 0;
+  int width_ = 0;
+  int height_ = 0;
+
+public:
+  OffscreenContext() = default;
+  ~OffscreenContext();
+  OffscreenContext(const OffscreenContext &) = delete;
+  OffscreenContext &operator=(const OffscreenContext &) = delete;
+
+  // 创建上下文并设为当前，加载 GL 函数，分配 width x height 的帧缓冲。失败时输出原因并返回 false
+  bool create(int width, int height);
+  void destroy();
+
+  void bind_framebuffer() const; // 绑定离屏帧缓冲并设置视口
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  std::string renderer() const; // GL_RENDERER 与 GL_VERSION
+};
+
+#endif
@@ -0,0 +1,359 @@
+#include "path_chunks.h"
+#include <algorithm>
+#include <cmath>
+
+static const float kLodBaseTolerance = 0.05f; // 第 1 级的允许偏差（米），之后每级乘以 4
+
+PathChunkStore::PathChunkStore()
+{
+  thread_ = std::thread(&PathChunkStore::worker_loop, this);
+}
+
+PathChunkStore::~PathChunkStore()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    requests_.clear();
+  }
+  wake_.notify_all();
+  thread_.join();
+}
+
+void PathChunkStore::set_path(const PathView &path, const PathFile *file, size_t chunk_size)
+{
+  clear();
+  path_ = path;
+  file_ = file;
+  normals_ = file != nullptr ? file->normals() : nullptr;
+  chunk_size_ = std::max(chunk_size, (size_t)1);
+  requested_.assign(chunk_count(), false);
+}
+
+void PathChunkStore::set_window(size_t chunks_behind, size_t chunks_ahead)
+{
+  chunks_behind_ = chunks_behind;
+  chunks_ahead_ = chunks_ahead;
+  window_valid_ = false;
+}
+
+void PathChunkStore::set_wrap(bool wrap)
+{
+  if (wrap_ != wrap)
+  {
+    wrap_ = wrap;
+    window_valid_ = false;
+  }
+}
+
+void PathChunkStore::clear()
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cancel_requests(lock);
+  }
+
+  // 只丢弃派生数据，映射页留给随后的重建或关闭文件
+  resident_.clear();
+  wanted_.clear();
+  std::fill(requested_.begin(), requested_.end(), false);
+  window_valid_ = false;
+}
+
+size_t PathChunkStore::chunk_count() const
+{
+  // 每块覆盖 chunk_size_ 段，n 个点共 n - 1 段
+  return path_.size() < 2 ? 0 : (path_.size() - 2) / chunk_size_ + 1;
+}
+
+bool PathChunkStore::update(size_t point_index)
+{
+  const size_t count = chunk_count();
+  if (count == 0)
+  {
+    return false;
+  }
+
+  bool changed = false;
+
+  // 取回后台准备好的分块；等待期间窗口已经移开的直接释放
+  std::vector<std::shared_ptr<const PathChunk>> completed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    completed.swap(completed_);
+  }
+  for (const std::shared_ptr<const PathChunk> &chunk : completed)
+  {
+    requested_[chunk->index] = false;
+    if (std::find(wanted_.begin(), wanted_.end(), chunk->index) != wanted_.end())
+    {
+      resident_[chunk->index] = chunk;
+      changed = true;
+    }
+    else
+    {
+      release_chunk(chunk->index);
+    }
+  }
+
+  const size_t center = std::min(point_index / chunk_size_, count - 1);
+  if (window_valid_ && center == center_chunk_)
+  {
+    return changed;
+  }
+  center_chunk_ = center;
+  window_valid_ = true;
+
+  // 当前分块优先，然后是前方（循环播放时越过末尾回到开头），最后是后方
+  wanted_.clear();
+  wanted_.push_back(center);
+  for (size_t i = 1; i <= chunks_ahead_; i++)
+  {
+    size_t index = center + i;
+    if (index >= count)
+    {
+      if (!wrap_)
+        break;
+      index %= count;
+    }
+    if (std::find(wanted_.begin(), wanted_.end(), index) == wanted_.end())
+      wanted_.push_back(index);
+  }
+  for (size_t i = 1; i <= chunks_behind_ && i <= center; i++)
+  {
+    if (std::find(wanted_.begin(), wanted_.end(), center - i) == wanted_.end())
+      wanted_.push_back(center - i);
+  }
+
+  // 移出窗口的分块释放
+  for (auto it = resident_.begin(); it != resident_.end();)
+  {
+    if (std::find(wanted_.begin(), wanted_.end(), it->first) == wanted_.end())
+    {
+      release_chunk(it->first);
+      it = resident_.erase(it);
+      changed = true;
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 跳转后还没开始处理的旧请求不再需要
+    for (auto it = requests_.begin(); it != requests_.end();)
+    {
+      if (std::find(wanted_.begin(), wanted_.end(), it->index) == wanted_.end())
+      {
+        requested_[it->index] = false;
+        it = requests_.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+
+    for (size_t index : wanted_)
+    {
+      if (resident_.count(index) == 0 && !requested_[index])
+      {
+        requests_.push_back(make_request(index));
+        requested_[index] = true;
+      }
+    }
+  }
+  wake_.notify_one();
+
+  return changed;
+}
+
+void PathChunkStore::cancel_requests(std::unique_lock<std::mutex> &lock)
+{
+  requests_.clear();
+  completed_.clear();
+  generation_++;
+
+  // 后台线程可能正在读旧路径，等它做完
+  idle_.wait(lock, [this]() { return !busy_; });
+}
+
+void PathChunkStore::release_chunk(size_t index)
+{
+  if (file_ != nullptr)
+  {
+    file_->release(index * chunk_size_, chunk_size_);
+  }
+}
+
+PathChunkStore::ChunkRequest PathChunkStore::make_request(size_t index) const
+{
+  ChunkRequest request;
+  request.index = index;
+  request.first = index * chunk_size_;
+  request.count = std::min(chunk_size_ + 1, path_.size() - request.first);
+  request.path = path_;
+  request.normals = normals_;
+  request.file = file_;
+  request.generation = generation_;
+  return request;
+}
+
+std::shared_ptr<const PathChunk> PathChunkStore::build_chunk(const ChunkRequest &request)
+{
+  // 先让系统整块读入，生成边界时逐点访问就不会一页一页地等磁盘
+  if (request.file != nullptr)
+  {
+    request.file->prefetch(request.first, request.count);
+  }
+
+  std::shared_ptr<PathChunk> chunk = std::make_shared<PathChunk>();
+  chunk->index = request.index;
+  chunk->first = request.first;
+  chunk->count = request.count;
+  chunk->track_vertices.reserve(request.count);
+
+  const PathView &path = request.path;
+  glm::vec3 bounds_min = glm::vec3(1e30f);
+  glm::vec3 bounds_max = glm::vec3(-1e30f);
+
+  for (size_t i = request.first; i < request.first + request.count; i++)
+  {
+    glm::vec3 position = path[i].position;
+
+    // 右侧方向（垂直于前进方向）：路径文件自带时直接使用，否则按相邻点计算
+    glm::vec3 right_dir;
+    if (request.normals != nullptr)
+    {
+      right_dir = glm::vec3(request.normals[i].x, 0.0f, request.normals[i].z);
+      if (glm::length(right_dir) < 0.5f)
+        continue; // 记录开头静止时导入端写的是零法向
+    }
+    else
+    {
+      glm::vec3 forward_dir = i + 1 < path.size() ? path[i + 1].position - position : position - path[i - 1].position;
+      if (glm::length(forward_dir) <= 0.001f)
+        continue;
+      right_dir = glm::normalize(glm::cross(glm::normalize(forward_dir), glm::vec3(0.0f, 1.0f, 0.0f)));
+    }
+
+    chunk->track_vertices.push_back(TrackVertex{glm::vec2(position.x, position.z), glm::vec2(right_dir.x, right_dir.z)});
+    bounds_min = glm::min(bounds_min, position);
+    bounds_max = glm::max(bounds_max, position);
+  }
+
+  if (!chunk->track_vertices.empty())
+  {
+    chunk->bounds_min = bounds_min;
+    chunk->bounds_max = bounds_max;
+  }
+
+  build_lod_levels(*chunk);
+  return chunk;
+}
+
+void PathChunkStore::build_lod_levels(PathChunk &chunk)
+{
+  const std::vector<TrackVertex> &vertices = chunk.track_vertices;
+  const size_t count = vertices.size();
+  chunk.lod_levels.push_back(PathChunkLod{0.0f, 0, (uint32_t)count});
+  if (count <= 2)
+  {
+    return;
+  }
+
+  // 一次 Douglas-Peucker 求出每个点的显著度：该点被选为分割点时的偏差，且不超过父区间的显著度。
+  // 容差为 e 的简化结果恰好是两个端点加上显著度大于 e 的点，各级都从这里直接取，不必重复简化
+  std::vector<float> significance(count, 0.0f);
+  significance[0] = significance[count - 1] = INFINITY;
+
+  struct Segment
+  {
+    size_t begin;
+    size_t end;
+    float limit;
+  };
+  std::vector<Segment> stack;
+  stack.push_back(Segment{0, count - 1, INFINITY});
+
+  while (!stack.empty())
+  {
+    Segment segment = stack.back();
+    stack.pop_back();
+    if (segment.end - segment.begin < 2)
+      continue;
+
+    const glm::vec2 a = vertices[segment.begin].position;
+    const glm::vec2 ab = vertices[segment.end].position - a;
+    const float length2 = glm::dot(ab, ab);
+
+    size_t farthest = segment.begin + 1;
+    float max_distance = -1.0f;
+    for (size_t i = segment.begin + 1; i < segment.end; i++)
+    {
+      // 到线段的距离（XZ 平面）
+      glm::vec2 ap = vertices[i].position - a;
+      float t = length2 > 0.0f ? glm::clamp(glm::dot(ap, ab) / length2, 0.0f, 1.0f) : 0.0f;
+      float distance = glm::length(ap - ab * t);
+      if (distance > max_distance)
+      {
+        max_distance = distance;
+        farthest = i;
+      }
+    }
+
+    float value = std::min(max_distance, segment.limit);
+    significance[farthest] = value;
+    stack.push_back(Segment{segment.begin, farthest, value});
+    stack.push_back(Segment{farthest, segment.end, value});
+  }
+
+  float tolerance = kLodBaseTolerance;
+  for (int level = 1; level < kMaxLodLevels; level++, tolerance *= 4.0f)
+  {
+    const uint32_t first = (uint32_t)chunk.lod_indices.size();
+    for (size_t i = 0; i < count; i++)
+    {
+      if (significance[i] > tolerance)
+        chunk.lod_indices.push_back((uint32_t)i);
+    }
+
+    const uint32_t level_count = (uint32_t)chunk.lod_indices.size() - first;
+    chunk.lod_levels.push_back(PathChunkLod{tolerance, first, level_count});
+
+    // 只剩两个端点后再粗也一样
+    if (level_count <= 2)
+      break;
+  }
+}
+
+void PathChunkStore::worker_loop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    wake_.wait(lock, [this]() { return stopping_ || !requests_.empty(); });
+    if (stopping_)
+    {
+      return;
+    }
+
+    ChunkRequest request = requests_.front();
+    requests_.pop_front();
+    busy_ = true;
+
+    lock.unlock();
+    std::shared_ptr<const PathChunk> chunk = build_chunk(request);
+    lock.lock();
+
+    busy_ = false;
+    if (request.generation == generation_)
+    {
+      completed_.push_back(chunk);
+    }
+    idle_.notify_all();
+  }
+}
@@ -0,0 +1,129 @@
+#ifndef __PATH_CHUNKS_H
+#define __PATH_CHUNKS_H
+#include <glm/glm.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "path_file.h"
+#include "path_view.h"
+
+// 赛道中心线上的点（XZ 平面）和右侧单位法向。与车道宽度无关，路面由顶点着色器沿法向按宽度挤出；
+// 正好是一个 RGBA32F texel，直接作为纹理缓冲上传
+struct TrackVertex
+{
+  glm::vec2 position;
+  glm::vec2 normal;
+};
+
+static_assert(sizeof(TrackVertex) == 16, "TrackVertex is uploaded as one RGBA32F texel");
+
+// 一个细节层级：保留的点在 PathChunk::lod_indices 中的区间
+struct PathChunkLod
+{
+  float tolerance; // 与原中心线的最大偏差（米），第 0 级为 0
+  uint32_t first;
+  uint32_t count;
+};
+
+// 路径的一个分块及其派生数据。分块末尾多带下一块的第一个点，相邻分块的边界线首尾相接
+struct PathChunk
+{
+  size_t index = 0; // 分块序号
+  size_t first = 0; // 第一个路径点
+  size_t count = 0; // 路径点数（含重叠的一个点）
+
+  std::vector<TrackVertex> track_vertices; // 跳过了方向无法确定的点
+
+  // 细节层级由 Douglas-Peucker 简化得到，逐级变粗，粗一级的点是细一级的子集。
+  // 第 0 级是全部点，不占 lod_indices
+  std::vector<PathChunkLod> lod_levels;
+  std::vector<uint32_t> lod_indices; // track_vertices 的下标，各级依次存放
+  glm::vec3 bounds_min = glm::vec3(0.0f);  // 中心线的包围盒，不含车道宽度
+  glm::vec3 bounds_max = glm::vec3(0.0f);
+};
+
+// 分块的路径存储：只让播放位置附近的一个窗口常驻，窗口外的分块连同派生数据一起释放，
+// 映射的路径文件还会把对应的页交还系统。前方的分块由后台线程预取（读入映射页、生成赛道边界），
+// 主线程只取用已经准备好的分块，播放任意长的记录内存占用都只与窗口大小有关
+class PathChunkStore
+{
+private:
+  // 交给后台线程的任务，带上生成时需要的全部参数，后台线程不读成员
+  struct ChunkRequest
+  {
+    size_t index;
+    size_t first;
+    size_t count;
+    PathView path;
+    const PathNormal *normals;
+    const PathFile *file;
+    unsigned int generation;
+  };
+
+  PathView path_;
+  const PathNormal *normals_ = nullptr; // 路径文件自带的法向，没有时按相邻点计算
+  const PathFile *file_ = nullptr;      // 路径来自映射文件时用于预取和释放页
+  size_t chunk_size_ = kDefaultChunkSize;
+  size_t chunks_behind_ = 1; // 已经播放过的一侧保留的分块数
+  size_t chunks_ahead_ = 2;  // 将要播放的一侧预取的分块数
+  bool wrap_ = true;         // 循环播放时路径末尾之后预取开头的分块
+  size_t center_chunk_ = 0;
+  bool window_valid_ = false;
+
+  std::map<size_t, std::shared_ptr<const PathChunk>> resident_; // 已经准备好的分块，只在主线程访问
+  std::vector<size_t> wanted_;                                   // 当前窗口内的分块，按预取优先级排列
+  std::vector<bool> requested_;                                  // 已提交但还没取回的分块
+
+  // 后台预取线程
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  std::deque<ChunkRequest> requests_;                    // 待处理的请求
+  std::vector<std::shared_ptr<const PathChunk>> completed_; // 处理完、等待主线程取走的分块
+  unsigned int generation_ = 0; // 路径变化时递增，过期的结果直接丢弃
+  bool busy_ = false;
+  bool stopping_ = false;
+
+public:
+  static const size_t kDefaultChunkSize = 16384; // 每个分块的路径点数
+  static const int kMaxLodLevels = 6;            // 含第 0 级
+
+  PathChunkStore();
+  ~PathChunkStore();
+  PathChunkStore(const PathChunkStore &) = delete;
+  PathChunkStore &operator=(const PathChunkStore &) = delete;
+
+  // 切换路径，file 为空表示路径在内存中。旧路径的分块全部丢弃
+  void set_path(const PathView &path, const PathFile *file, size_t chunk_size = kDefaultChunkSize);
+  void set_window(size_t chunks_behind, size_t chunks_ahead);
+  void set_wrap(bool wrap);
+
+  // 丢弃所有分块并等待后台线程空闲。释放路径（例如关闭映射文件）之前必须调用
+  void clear();
+
+  // 按当前播放的路径点移动窗口，取回后台准备好的分块。常驻分块有变化时返回 true
+  bool update(size_t point_index);
+
+  size_t chunk_size() const { return chunk_size_; }
+  size_t chunk_count() const;
+  size_t resident_count() const { return resident_.size(); }
+  const std::map<size_t, std::shared_ptr<const PathChunk>> &resident() const { return resident_; }
+
+private:
+  void cancel_requests(std::unique_lock<std::mutex> &lock); // 清空请求并等待后台线程空闲
+  void release_chunk(size_t index);
+  ChunkRequest make_request(size_t index) const;
+  static std::shared_ptr<const PathChunk> build_chunk(const ChunkRequest &request);
+  static void build_lod_levels(PathChunk &chunk);
+  void worker_loop();
+};
+
+#endif
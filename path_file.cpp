@@ -0,0 +1,470 @@
+#include "path_file.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PATH_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char kPathFileMagic[8] = {'S', 'P', 'P', 'A', 'T', 'H', 0, 0};
+static const uint32_t kPathFileByteOrder = 0x01020304u;
+static const uint64_t kPathFileAlignment = 64;
+static const size_t kWriterBatchSize = 65536; // 写入端每攒够这么多点写出一次
+
+// 版本 1 的路径点：时间戳为 float
+struct PathPointV1
+{
+  float x, y, z;
+  float yaw;
+  float timestamp;
+};
+static const uint32_t kPathFileVersion1 = 1;
+
+static uint64_t align_offset(uint64_t offset)
+{
+  return (offset + kPathFileAlignment - 1) / kPathFileAlignment * kPathFileAlignment;
+}
+
+PathFile::~PathFile()
+{
+  close();
+}
+
+bool PathFile::open(const std::string &file_path)
+{
+  close();
+
+  size_t file_size = 0;
+  if (!map_file(file_path, file_size))
+  {
+    return false;
+  }
+
+  const char *data = mapping_ != nullptr ? (const char *)mapping_ : buffer_.data();
+  PathFileHeader header;
+  if (file_size < sizeof(header))
+  {
+    std::cout << "ERROR::PATH_FILE::TRUNCATED_HEADER: " << file_path << std::endl;
+    close();
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+
+  if (memcmp(header.magic, kPathFileMagic, sizeof(kPathFileMagic)) != 0)
+  {
+    std::cout << "ERROR::PATH_FILE::BAD_MAGIC: " << file_path << std::endl;
+    close();
+    return false;
+  }
+
+  const bool version1 = header.version == kPathFileVersion1 && header.record_size == sizeof(PathPointV1);
+  if (header.byte_order != kPathFileByteOrder ||
+      (!version1 && (header.version != kPathFileVersion || header.record_size != sizeof(PathPoint))))
+  {
+    std::cout << "ERROR::PATH_FILE::UNSUPPORTED_FORMAT: " << file_path << " (version " << header.version
+              << ", record size " << header.record_size << ")" << std::endl;
+    close();
+    return false;
+  }
+
+  // 只检查路径点数组落在文件内，不逐点校验，否则打开时就要读完整个文件
+  if (header.points_offset % alignof(PathPoint) != 0 || header.points_offset > file_size ||
+      header.point_count > (file_size - header.points_offset) / header.record_size)
+  {
+    std::cout << "ERROR::PATH_FILE::TRUNCATED_POINTS: " << file_path << std::endl;
+    close();
+    return false;
+  }
+
+  if ((header.flags & kPathFileHasNormals) != 0)
+  {
+    if (header.normals_offset % alignof(PathNormal) != 0 || header.normals_offset > file_size ||
+        header.point_count > (file_size - header.normals_offset) / sizeof(PathNormal))
+    {
+      std::cout << "ERROR::PATH_FILE::TRUNCATED_NORMALS: " << file_path << std::endl;
+      close();
+      return false;
+    }
+    normals_ = (const PathNormal *)(data + header.normals_offset);
+  }
+
+  if ((header.flags & kPathFileHasOrigin) != 0)
+  {
+    if (header.origin_offset > file_size || file_size - header.origin_offset < sizeof(PathOrigin))
+    {
+      std::cout << "ERROR::PATH_FILE::TRUNCATED_ORIGIN: " << file_path << std::endl;
+      close();
+      return false;
+    }
+    memcpy(&origin_, data + header.origin_offset, sizeof(origin_));
+  }
+
+  if (version1)
+  {
+    // 旧格式只能逐点转换成双精度时间戳，整个文件读入一遍
+    const PathPointV1 *points = (const PathPointV1 *)(data + header.points_offset);
+    converted_points_.resize((size_t)header.point_count);
+    for (size_t i = 0; i < converted_points_.size(); i++)
+    {
+      converted_points_[i] = PathPoint{glm::vec3(points[i].x, points[i].y, points[i].z), points[i].yaw, points[i].timestamp};
+    }
+    float duration;
+    memcpy(&duration, data + offsetof(PathFileHeader, duration), sizeof(duration));
+    view_ = PathView(converted_points_);
+    duration_ = duration;
+    return true;
+  }
+
+  view_ = PathView((const PathPoint *)(data + header.points_offset), (size_t)header.point_count);
+  duration_ = header.duration;
+  return true;
+}
+
+void PathFile::close()
+{
+#ifdef PATH_FILE_MMAP
+  if (mapping_ != nullptr)
+  {
+    munmap(mapping_, mapping_size_);
+  }
+#endif
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+  buffer_.clear();
+  buffer_.shrink_to_fit();
+  std::vector<PathPoint>().swap(converted_points_);
+  view_ = PathView();
+  normals_ = nullptr;
+  origin_ = PathOrigin{0.0, 0.0, 0.0};
+  duration_ = 0.0;
+}
+
+void PathFile::swap(PathFile &other)
+{
+  std::swap(mapping_, other.mapping_);
+  std::swap(mapping_size_, other.mapping_size_);
+  buffer_.swap(other.buffer_);
+  converted_points_.swap(other.converted_points_);
+  std::swap(view_, other.view_);
+  std::swap(normals_, other.normals_);
+  std::swap(origin_, other.origin_);
+  std::swap(duration_, other.duration_);
+}
+
+// 版本 1 文件的路径点已转换到堆上，只对映射的法向给出提示
+void PathFile::prefetch(size_t first, size_t count) const
+{
+  if (first >= view_.size())
+  {
+    return;
+  }
+  count = std::min(count, view_.size() - first);
+  if (converted_points_.empty())
+  {
+    advise(view_.points + first, count * sizeof(PathPoint), true);
+  }
+  if (normals_ != nullptr)
+  {
+    advise(normals_ + first, count * sizeof(PathNormal), true);
+  }
+}
+
+void PathFile::release(size_t first, size_t count) const
+{
+  if (first >= view_.size())
+  {
+    return;
+  }
+  count = std::min(count, view_.size() - first);
+  if (converted_points_.empty())
+  {
+    advise(view_.points + first, count * sizeof(PathPoint), false);
+  }
+  if (normals_ != nullptr)
+  {
+    advise(normals_ + first, count * sizeof(PathNormal), false);
+  }
+}
+
+void PathFile::advise(const void *begin, size_t bytes, bool will_need) const
+{
+#ifdef PATH_FILE_MMAP
+  if (mapping_ == nullptr || bytes == 0)
+  {
+    return;
+  }
+
+  // madvise 要求页对齐，区间向外扩到整页。映射只读，释放相邻区间共用的页也只是下次访问时重新读入
+  const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+  uintptr_t start = (uintptr_t)begin / page_size * page_size;
+  uintptr_t end = ((uintptr_t)begin + bytes + page_size - 1) / page_size * page_size;
+  end = std::min(end, (uintptr_t)mapping_ + mapping_size_);
+
+  if (start < end)
+  {
+    madvise((void *)start, end - start, will_need ? MADV_WILLNEED : MADV_DONTNEED);
+  }
+#else
+  (void)begin;
+  (void)bytes;
+  (void)will_need;
+#endif
+}
+
+bool PathFile::map_file(const std::string &file_path, size_t &file_size)
+{
+#ifdef PATH_FILE_MMAP
+  int fd = ::open(file_path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    std::cout << "ERROR::PATH_FILE::OPEN_FAILED: " << file_path << std::endl;
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0)
+  {
+    std::cout << "ERROR::PATH_FILE::OPEN_FAILED: " << file_path << std::endl;
+    ::close(fd);
+    return false;
+  }
+
+  file_size = (size_t)file_stat.st_size;
+  void *mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // 映射建立后文件描述符就不再需要
+  ::close(fd);
+  if (mapping == MAP_FAILED)
+  {
+    std::cout << "ERROR::PATH_FILE::MMAP_FAILED: " << file_path << std::endl;
+    return false;
+  }
+
+  mapping_ = mapping;
+  mapping_size_ = file_size;
+  return true;
+#else
+  std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+  if (!file)
+  {
+    std::cout << "ERROR::PATH_FILE::OPEN_FAILED: " << file_path << std::endl;
+    return false;
+  }
+
+  file_size = (size_t)file.tellg();
+  buffer_.resize(file_size);
+  file.seekg(0);
+  if (!file.read(buffer_.data(), (std::streamsize)file_size))
+  {
+    std::cout << "ERROR::PATH_FILE::READ_FAILED: " << file_path << std::endl;
+    buffer_.clear();
+    return false;
+  }
+  return true;
+#endif
+}
+
+PathFileWriter::~PathFileWriter()
+{
+  if (file_ != nullptr)
+  {
+    abandon();
+  }
+}
+
+bool PathFileWriter::open(const std::string &file_path, bool with_normals)
+{
+  if (file_ != nullptr)
+  {
+    abandon();
+  }
+
+  file_path_ = file_path;
+  point_count_ = 0;
+  last_timestamp_ = 0.0;
+  has_origin_ = false;
+  points_.clear();
+  normals_.clear();
+
+  file_ = fopen(file_path.c_str(), "wb");
+  if (file_ == nullptr)
+  {
+    std::cout << "ERROR::PATH_FILE::OUTPUT_NOT_WRITABLE: " << file_path << std::endl;
+    return false;
+  }
+
+  if (with_normals)
+  {
+    normals_file_ = tmpfile();
+    if (normals_file_ == nullptr)
+    {
+      std::cout << "ERROR::PATH_FILE::TEMP_FILE_FAILED" << std::endl;
+      abandon();
+      return false;
+    }
+  }
+
+  // 先占住文件头的位置，finish() 时回填
+  PathFileHeader header;
+  memset(&header, 0, sizeof(header));
+  ok_ = fwrite(&header, sizeof(header), 1, file_) == 1;
+  return ok_;
+}
+
+bool PathFileWriter::append(const PathPoint &point, const PathNormal &normal)
+{
+  if (file_ == nullptr || !ok_)
+  {
+    return false;
+  }
+
+  if (point_count_ > 0 && point.timestamp < last_timestamp_)
+  {
+    std::cout << "ERROR::PATH_FILE::UNSORTED_TIMESTAMPS: point " << point_count_ << std::endl;
+    ok_ = false;
+    return false;
+  }
+
+  points_.push_back(point);
+  if (normals_file_ != nullptr)
+  {
+    normals_.push_back(normal);
+  }
+  last_timestamp_ = point.timestamp;
+  point_count_++;
+
+  return points_.size() < kWriterBatchSize || flush();
+}
+
+void PathFileWriter::set_origin(const PathOrigin &origin)
+{
+  origin_ = origin;
+  has_origin_ = true;
+}
+
+bool PathFileWriter::flush()
+{
+  if (!points_.empty())
+  {
+    ok_ = ok_ && fwrite(points_.data(), sizeof(PathPoint), points_.size(), file_) == points_.size();
+  }
+  if (!normals_.empty())
+  {
+    ok_ = ok_ && fwrite(normals_.data(), sizeof(PathNormal), normals_.size(), normals_file_) == normals_.size();
+  }
+  points_.clear();
+  normals_.clear();
+
+  if (!ok_)
+  {
+    std::cout << "ERROR::PATH_FILE::WRITE_FAILED: " << file_path_ << std::endl;
+  }
+  return ok_;
+}
+
+bool PathFileWriter::finish()
+{
+  if (file_ == nullptr || !ok_ || !flush())
+  {
+    abandon();
+    return false;
+  }
+
+  PathFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kPathFileMagic, sizeof(kPathFileMagic));
+  header.version = kPathFileVersion;
+  header.byte_order = kPathFileByteOrder;
+  header.record_size = sizeof(PathPoint);
+  header.point_count = point_count_;
+  header.points_offset = align_offset(sizeof(header));
+  header.duration = last_timestamp_;
+
+  // 法向数组接在路径点之后，按 64 字节对齐
+  uint64_t data_end = header.points_offset + point_count_ * sizeof(PathPoint);
+  if (normals_file_ != nullptr)
+  {
+    uint64_t points_end = header.points_offset + point_count_ * sizeof(PathPoint);
+    header.flags |= kPathFileHasNormals;
+    header.normals_offset = align_offset(points_end);
+
+    static const char padding[kPathFileAlignment] = {};
+    ok_ = fwrite(padding, 1, (size_t)(header.normals_offset - points_end), file_) == header.normals_offset - points_end;
+
+    // 分块拷贝临时文件，内存占用固定
+    char buffer[1 << 16];
+    rewind(normals_file_);
+    size_t read_bytes;
+    while (ok_ && (read_bytes = fread(buffer, 1, sizeof(buffer), normals_file_)) > 0)
+    {
+      ok_ = fwrite(buffer, 1, read_bytes, file_) == read_bytes;
+    }
+    fclose(normals_file_);
+    normals_file_ = nullptr;
+    data_end = header.normals_offset + point_count_ * sizeof(PathNormal);
+  }
+
+  // 原点放在最后，写入端到 finish() 时才需要知道它
+  if (has_origin_)
+  {
+    header.flags |= kPathFileHasOrigin;
+    header.origin_offset = align_offset(data_end);
+
+    static const char padding[kPathFileAlignment] = {};
+    ok_ = ok_ && fwrite(padding, 1, (size_t)(header.origin_offset - data_end), file_) == header.origin_offset - data_end;
+    ok_ = ok_ && fwrite(&origin_, sizeof(origin_), 1, file_) == 1;
+  }
+
+  ok_ = ok_ && fseek(file_, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file_) == 1;
+  ok_ = fclose(file_) == 0 && ok_;
+  file_ = nullptr;
+
+  if (!ok_)
+  {
+    std::cout << "ERROR::PATH_FILE::WRITE_FAILED: " << file_path_ << std::endl;
+    remove(file_path_.c_str());
+  }
+  return ok_;
+}
+
+void PathFileWriter::abandon()
+{
+  if (normals_file_ != nullptr)
+  {
+    fclose(normals_file_);
+    normals_file_ = nullptr;
+  }
+  if (file_ != nullptr)
+  {
+    fclose(file_);
+    file_ = nullptr;
+    remove(file_path_.c_str());
+  }
+  ok_ = false;
+}
+
+bool write_path_file(const std::string &file_path, const PathView &path)
+{
+  PathFileWriter writer;
+  if (!writer.open(file_path, false))
+  {
+    return false;
+  }
+
+  for (size_t i = 0; i < path.size(); i++)
+  {
+    if (!writer.append(path[i]))
+    {
+      return false;
+    }
+  }
+  return writer.finish();
+}
@@ -0,0 +1,133 @@
+#ifndef __PATH_FILE_H
+#define __PATH_FILE_H
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "path_view.h"
+
+// 路径点处的右侧单位法向（XZ 平面），用于生成赛道边界
+struct PathNormal
+{
+  float x;
+  float z;
+};
+
+// 路径原点的世界坐标。路径点存的是相对原点的 float 坐标，城市级的绝对坐标（如 UTM，数百万米）
+// 直接存成 float 只有分米级精度，减去原点后几十公里范围内仍是毫米级
+struct PathOrigin
+{
+  double x;
+  double y;
+  double z;
+};
+
+// 二进制路径文件（小端）：
+//   [0, 64)           PathFileHeader
+//   [points_offset)   point_count 个连续存放的 PathPoint（x, y, z, yaw 为 float，timestamp 为 double）
+//   [normals_offset)  可选，point_count 个 PathNormal（flags 含 kPathFileHasNormals 时存在）
+//   [origin_offset)   可选，一个 PathOrigin（flags 含 kPathFileHasOrigin 时存在），没有时原点为 0
+// 路径点的内存布局与 PathPoint 完全一致，映射后直接作为路径使用，不做任何解析；
+// 时间戳必须单调不减，由写入端保证。
+// 版本 1 的时间戳和时长是 float（路径点 20 字节），打开时整体读入并转换，不再按需映射
+struct PathFileHeader
+{
+  char magic[8];          // "SPPATH\0\0"
+  uint32_t version;       // 格式版本
+  uint32_t byte_order;    // 写入端的 0x01020304，用于识别字节序不同的文件
+  uint32_t record_size;   // 每个路径点的字节数，等于 sizeof(PathPoint)
+  uint32_t flags;          // kPathFileHasNormals 等
+  uint64_t point_count;    // 路径点数
+  uint64_t points_offset;  // 路径点数组相对文件头的偏移，按 64 字节对齐
+  double duration;         // 最后一个路径点的时间戳，免得打开时访问文件末尾（版本 1 为 float 加 4 字节填充）
+  uint64_t normals_offset; // 法向数组的偏移，没有时为 0
+  uint64_t origin_offset;  // 路径原点的偏移，没有时为 0（早期文件这里是保留的 0）
+};
+
+static_assert(sizeof(PathFileHeader) == 64, "PathFileHeader must stay 64 bytes");
+static_assert(sizeof(PathPoint) == 24, "PathPoint is stored in path files as four floats and a double");
+
+static const uint32_t kPathFileVersion = 2;
+static const uint32_t kPathFileHasNormals = 1u << 0;
+static const uint32_t kPathFileHasOrigin = 1u << 1;
+
+// 只读打开的路径文件。POSIX 平台用 mmap 映射，路径点在播放访问时才由系统按页读入，
+// 打开多 GB 的文件也不需要等待；其他平台退化为整体读入内存
+class PathFile
+{
+private:
+  void *mapping_ = nullptr;  // 映射的整个文件
+  size_t mapping_size_ = 0;
+  std::vector<char> buffer_; // 不支持 mmap 时的文件内容
+  std::vector<PathPoint> converted_points_; // 版本 1 文件转换后的路径点
+  PathView view_;
+  const PathNormal *normals_ = nullptr;
+  PathOrigin origin_ = PathOrigin{0.0, 0.0, 0.0};
+  double duration_ = 0.0;
+
+public:
+  PathFile() = default;
+  ~PathFile();
+  PathFile(const PathFile &) = delete;
+  PathFile &operator=(const PathFile &) = delete;
+
+  bool open(const std::string &file_path); // 校验文件头后映射，失败时保持关闭状态
+  void close();
+  void swap(PathFile &other); // 交换两个文件的映射，已有的视图仍然有效
+
+  bool is_open() const { return view_.points != nullptr; }
+  const PathView &view() const { return view_; }
+  const PathNormal *normals() const { return normals_; } // 文件不带法向时为空
+  const PathOrigin &origin() const { return origin_; }   // 路径点加上原点即为世界坐标
+  double duration() const { return duration_; }
+
+  // 驻留提示，以路径点为单位（法向同步处理）。prefetch 让系统提前读入，
+  // release 丢弃区间所在的页，之后再访问会重新从文件读入；不是映射时什么都不做
+  void prefetch(size_t first, size_t count) const;
+  void release(size_t first, size_t count) const;
+
+private:
+  void advise(const void *begin, size_t bytes, bool will_need) const;
+  bool map_file(const std::string &file_path, size_t &file_size);
+};
+
+// 流式写入路径文件：路径点逐个追加，内存占用与路径长度无关。
+// 法向先写入临时文件，finish() 时拼接到路径点之后并回填文件头
+class PathFileWriter
+{
+private:
+  std::string file_path_;
+  FILE *file_ = nullptr;
+  FILE *normals_file_ = nullptr;      // 法向的临时文件，不写法向时为空
+  std::vector<PathPoint> points_;     // 待写出的路径点
+  std::vector<PathNormal> normals_;   // 待写出的法向
+  uint64_t point_count_ = 0;
+  double last_timestamp_ = 0.0;
+  PathOrigin origin_ = PathOrigin{0.0, 0.0, 0.0};
+  bool has_origin_ = false;
+  bool ok_ = false;
+
+public:
+  PathFileWriter() = default;
+  ~PathFileWriter(); // 未调用 finish() 时删除不完整的文件
+  PathFileWriter(const PathFileWriter &) = delete;
+  PathFileWriter &operator=(const PathFileWriter &) = delete;
+
+  bool open(const std::string &file_path, bool with_normals);
+  bool append(const PathPoint &point, const PathNormal &normal = PathNormal{0.0f, 0.0f}); // 时间戳回退时失败
+  void set_origin(const PathOrigin &origin); // 写入的路径点相对这个原点，finish() 之前任何时候都可以设置
+  bool finish();
+
+  uint64_t point_count() const { return point_count_; }
+
+private:
+  bool flush();
+  void abandon();
+};
+
+// 把路径写成二进制路径文件，时间戳不是单调不减时拒绝写入
+bool write_path_file(const std::string &file_path, const PathView &path);
+
+#endif
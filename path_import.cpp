@@ -0,0 +1,502 @@
+#include "path_import.h"
+#include "path_file.h"
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+static const size_t kReadChunkSize = 1 << 20; // 每次读入 1MB，单行不能超过这个长度
+
+// 一条记录中可识别的字段
+enum PathField
+{
+  kFieldX,
+  kFieldY,
+  kFieldZ,
+  kFieldTime,
+  kFieldYaw,
+  kFieldCount
+};
+
+struct PathRecord
+{
+  double values[kFieldCount];
+  bool present[kFieldCount];
+};
+
+static inline bool is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool is_digit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+// 解析十进制浮点数（可带符号、小数点和指数），不依赖区域设置也不分配内存。
+// 有效数字超过 19 位时只保留前 19 位，对写入 float 的路径点已足够
+static bool parse_number(const char *&p, const char *end, double &value)
+{
+  static const double kPowersOf10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                       1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char *s = p;
+  bool negative = false;
+  if (s < end && (*s == '-' || *s == '+'))
+  {
+    negative = *s == '-';
+    s++;
+  }
+
+  uint64_t mantissa = 0;
+  int exponent = 0;
+  int significant = 0;
+  int digits = 0;
+  for (; s < end && is_digit(*s); s++, digits++)
+  {
+    if (significant < 19)
+    {
+      mantissa = mantissa * 10 + (uint64_t)(*s - '0');
+      significant += mantissa != 0;
+    }
+    else
+    {
+      exponent++;
+    }
+  }
+
+  if (s < end && *s == '.')
+  {
+    for (s++; s < end && is_digit(*s); s++, digits++)
+    {
+      if (significant < 19)
+      {
+        mantissa = mantissa * 10 + (uint64_t)(*s - '0');
+        significant += mantissa != 0;
+        exponent--;
+      }
+    }
+  }
+
+  if (digits == 0)
+  {
+    return false;
+  }
+
+  if (s < end && (*s == 'e' || *s == 'E'))
+  {
+    const char *e = s + 1;
+    bool exponent_negative = false;
+    if (e < end && (*e == '-' || *e == '+'))
+    {
+      exponent_negative = *e == '-';
+      e++;
+    }
+
+    if (e < end && is_digit(*e))
+    {
+      int explicit_exponent = 0;
+      for (; e < end && is_digit(*e); e++)
+      {
+        explicit_exponent = explicit_exponent < 10000 ? explicit_exponent * 10 + (*e - '0') : explicit_exponent;
+      }
+      exponent += exponent_negative ? -explicit_exponent : explicit_exponent;
+      s = e;
+    }
+  }
+
+  // 10 的 22 次方以内可以精确表示，用乘除保证结果正确舍入
+  double result = (double)mantissa;
+  if (exponent < 0)
+  {
+    result = -exponent <= 22 ? result / kPowersOf10[-exponent] : result * std::pow(10.0, exponent);
+  }
+  else if (exponent > 0)
+  {
+    result = exponent <= 22 ? result * kPowersOf10[exponent] : result * std::pow(10.0, exponent);
+  }
+
+  value = negative ? -result : result;
+  p = s;
+  return true;
+}
+
+static bool name_equals(const char *name, size_t length, const char *expected)
+{
+  size_t i = 0;
+  for (; i < length && expected[i] != '\0'; i++)
+  {
+    char c = name[i];
+    if (c >= 'A' && c <= 'Z')
+    {
+      c = (char)(c - 'A' + 'a');
+    }
+    if (c != expected[i])
+    {
+      return false;
+    }
+  }
+  return i == length && expected[i] == '\0';
+}
+
+// 列名或键名对应的字段，不认识的返回 -1
+static int field_from_name(const char *name, size_t length)
+{
+  if (name_equals(name, length, "x"))
+    return kFieldX;
+  if (name_equals(name, length, "y"))
+    return kFieldY;
+  if (name_equals(name, length, "z"))
+    return kFieldZ;
+  if (name_equals(name, length, "t") || name_equals(name, length, "time") || name_equals(name, length, "timestamp"))
+    return kFieldTime;
+  if (name_equals(name, length, "yaw") || name_equals(name, length, "heading"))
+    return kFieldYaw;
+  return -1;
+}
+
+// 增量计算朝向和法向：每个点要等到下一个点到来才能确定前进方向，所以延迟一个点写出
+class PathStreamBuilder
+{
+private:
+  PathFileWriter &writer_;
+  PathPoint pending_;
+  bool pending_has_yaw_ = false;
+  bool has_pending_ = false;
+  float yaw_ = 0.0f;                      // 最近一次有效的前进方向
+  PathNormal normal_ = PathNormal{0.0f, 0.0f}; // 第一次移动之前没有方向，写零法向，生成路面时跳过这些点
+
+public:
+  explicit PathStreamBuilder(PathFileWriter &writer) : writer_(writer) {}
+
+  void set_origin(const PathOrigin &origin) { writer_.set_origin(origin); }
+
+  bool push(const PathPoint &point, bool has_yaw)
+  {
+    bool ok = !has_pending_ || emit(&point.position);
+    pending_ = point;
+    pending_has_yaw_ = has_yaw;
+    has_pending_ = true;
+    return ok;
+  }
+
+  // 最后一个点沿用前一段的方向（记录的行驶路径不一定闭合）
+  bool finish()
+  {
+    return !has_pending_ || emit(nullptr);
+  }
+
+private:
+  bool emit(const glm::vec3 *next_position)
+  {
+    if (next_position != nullptr)
+    {
+      // 与 PathChunkStore 生成赛道边界时相同：右侧 = 前进方向叉乘 Y 轴；方向太短时沿用上一个
+      glm::vec3 direction = *next_position - pending_.position;
+      if (glm::length(direction) > 0.001f)
+      {
+        yaw_ = glm::degrees(std::atan2(direction.x, direction.z));
+      }
+
+      float horizontal = std::sqrt(direction.x * direction.x + direction.z * direction.z);
+      if (horizontal > 0.001f)
+      {
+        normal_ = PathNormal{-direction.z / horizontal, direction.x / horizontal};
+      }
+    }
+
+    PathPoint point = pending_;
+    if (!pending_has_yaw_)
+    {
+      point.yaw = yaw_;
+    }
+    return writer_.append(point, normal_);
+  }
+};
+
+// 逐行解析，记住格式、列映射和起始时间
+class PathLineParser
+{
+private:
+  enum Format
+  {
+    kFormatUnknown,
+    kFormatCSV,
+    kFormatNDJSON
+  };
+
+  Format format_ = kFormatUnknown;
+  std::vector<int> columns_;      // CSV 每列对应的字段
+  bool first_point_ = true;
+  double start_time_ = 0.0;       // 第一个点的原始时间戳
+  PathOrigin origin_ = PathOrigin{0.0, 0.0, 0.0}; // 第一个点的原始坐标，作为路径原点
+  double last_time_ = 0.0;
+  PathStreamBuilder &builder_;
+  PathImportResult &result_;
+
+public:
+  PathLineParser(PathStreamBuilder &builder, PathImportResult &result) : builder_(builder), result_(result) {}
+
+  bool parse_line(const char *line, const char *end)
+  {
+    while (line < end && is_space(*line))
+    {
+      line++;
+    }
+    while (end > line && is_space(end[-1]))
+    {
+      end--;
+    }
+    if (line == end || *line == '#')
+    {
+      return true;
+    }
+
+    result_.lines++;
+    if (format_ == kFormatUnknown)
+    {
+      format_ = *line == '{' ? kFormatNDJSON : kFormatCSV;
+      if (format_ == kFormatCSV && parse_csv_header(line, end))
+      {
+        return true;
+      }
+    }
+
+    PathRecord record;
+    memset(&record, 0, sizeof(record));
+    if (format_ == kFormatCSV)
+    {
+      parse_csv_fields(line, end, record);
+    }
+    else
+    {
+      parse_json_fields(line, end, record);
+    }
+    return add_record(record);
+  }
+
+private:
+  // 第一个字段不是数字时视为表头；否则使用默认列顺序
+  bool parse_csv_header(const char *line, const char *end)
+  {
+    const char *p = line;
+    double value;
+    bool numeric = parse_number(p, end, value);
+    if (numeric)
+    {
+      columns_ = {kFieldX, kFieldY, kFieldZ, kFieldTime, kFieldYaw};
+      return false;
+    }
+
+    while (line <= end)
+    {
+      const char *comma = (const char *)memchr(line, ',', end - line);
+      const char *field_end = comma != nullptr ? comma : end;
+      const char *name = line;
+      const char *name_end = field_end;
+      while (name < name_end && (is_space(*name) || *name == '"'))
+      {
+        name++;
+      }
+      while (name_end > name && (is_space(name_end[-1]) || name_end[-1] == '"'))
+      {
+        name_end--;
+      }
+      columns_.push_back(field_from_name(name, name_end - name));
+      if (comma == nullptr)
+      {
+        break;
+      }
+      line = comma + 1;
+    }
+    return true;
+  }
+
+  void parse_csv_fields(const char *line, const char *end, PathRecord &record)
+  {
+    for (size_t column = 0; column < columns_.size() && line <= end; column++)
+    {
+      const char *comma = (const char *)memchr(line, ',', end - line);
+      const char *field_end = comma != nullptr ? comma : end;
+
+      int field = columns_[column];
+      if (field >= 0)
+      {
+        const char *p = line;
+        while (p < field_end && is_space(*p))
+        {
+          p++;
+        }
+        record.present[field] = parse_number(p, field_end, record.values[field]);
+      }
+
+      if (comma == nullptr)
+      {
+        break;
+      }
+      line = comma + 1;
+    }
+  }
+
+  // 只取认识的键，值必须是数字；其他键和值直接跳过
+  void parse_json_fields(const char *line, const char *end, PathRecord &record)
+  {
+    const char *p = line;
+    while (p < end)
+    {
+      const char *key = (const char *)memchr(p, '"', end - p);
+      if (key == nullptr)
+      {
+        break;
+      }
+      key++;
+      const char *key_end = (const char *)memchr(key, '"', end - key);
+      if (key_end == nullptr)
+      {
+        break;
+      }
+
+      p = key_end + 1;
+      while (p < end && is_space(*p))
+      {
+        p++;
+      }
+      if (p < end && *p == ':')
+      {
+        p++;
+        while (p < end && is_space(*p))
+        {
+          p++;
+        }
+        int field = field_from_name(key, key_end - key);
+        if (field >= 0)
+        {
+          record.present[field] = parse_number(p, end, record.values[field]);
+        }
+      }
+    }
+  }
+
+  bool add_record(const PathRecord &record)
+  {
+    if (!record.present[kFieldX] || !record.present[kFieldZ] || !record.present[kFieldTime])
+    {
+      result_.skipped++;
+      return true;
+    }
+
+    if (first_point_)
+    {
+      start_time_ = record.values[kFieldTime];
+      origin_ = PathOrigin{record.values[kFieldX], record.present[kFieldY] ? record.values[kFieldY] : 0.0,
+                           record.values[kFieldZ]};
+      builder_.set_origin(origin_);
+      first_point_ = false;
+    }
+
+    // 相对时间在双精度下计算并以双精度保存，原始时间戳（如 Unix 时间）再大、记录再长也不损失精度；时间回退的点跳过
+    double time = record.values[kFieldTime] - start_time_;
+    if (result_.points > 0 && time < last_time_)
+    {
+      result_.skipped++;
+      return true;
+    }
+    last_time_ = time;
+
+    // 坐标同样先在双精度下减去原点，UTM 这样的大坐标直接转成 float 会损失到分米级
+    PathPoint point;
+    point.position = glm::vec3((float)(record.values[kFieldX] - origin_.x),
+                               record.present[kFieldY] ? (float)(record.values[kFieldY] - origin_.y) : 0.0f,
+                               (float)(record.values[kFieldZ] - origin_.z));
+    point.yaw = record.present[kFieldYaw] ? (float)record.values[kFieldYaw] : 0.0f;
+    point.timestamp = time;
+    result_.points++;
+    return builder_.push(point, record.present[kFieldYaw]);
+  }
+};
+
+bool import_path_file(const std::string &input_path, const std::string &output_path, PathImportResult *result)
+{
+  FILE *input = fopen(input_path.c_str(), "rb");
+  if (input == nullptr)
+  {
+    std::cout << "ERROR::PATH_IMPORT::OPEN_FAILED: " << input_path << std::endl;
+    return false;
+  }
+
+  PathFileWriter writer;
+  if (!writer.open(output_path, true))
+  {
+    fclose(input);
+    return false;
+  }
+
+  PathImportResult stats;
+  PathStreamBuilder builder(writer);
+  PathLineParser parser(builder, stats);
+
+  using clock = std::chrono::steady_clock;
+  const clock::time_point start = clock::now();
+
+  // 固定大小的读缓冲区，不完整的最后一行移到缓冲区开头与下一块拼接
+  std::vector<char> buffer(kReadChunkSize);
+  size_t carry = 0;
+  bool ok = true;
+  while (ok)
+  {
+    size_t read_bytes = fread(buffer.data() + carry, 1, buffer.size() - carry, input);
+    stats.bytes += read_bytes;
+
+    const char *line = buffer.data();
+    const char *end = line + carry + read_bytes;
+    const char *newline;
+    while (ok && (newline = (const char *)memchr(line, '\n', end - line)) != nullptr)
+    {
+      ok = parser.parse_line(line, newline);
+      line = newline + 1;
+    }
+
+    carry = end - line;
+    if (read_bytes == 0)
+    {
+      // 文件末尾没有换行的最后一行
+      ok = ok && parser.parse_line(line, end);
+      break;
+    }
+
+    if (carry == buffer.size())
+    {
+      std::cout << "ERROR::PATH_IMPORT::LINE_TOO_LONG: " << input_path << std::endl;
+      ok = false;
+      break;
+    }
+    memmove(buffer.data(), line, carry);
+  }
+
+  if (ferror(input))
+  {
+    std::cout << "ERROR::PATH_IMPORT::READ_FAILED: " << input_path << std::endl;
+    ok = false;
+  }
+  fclose(input);
+
+  ok = ok && builder.finish() && writer.finish();
+  if (!ok)
+  {
+    return false;
+  }
+
+  const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+  std::cout << "imported " << stats.points << " points from " << stats.bytes / (1024.0 * 1024.0) << " MB in " << seconds
+            << " s (" << (seconds > 0.0 ? stats.bytes / (1024.0 * 1024.0) / seconds : 0.0) << " MB/s), skipped "
+            << stats.skipped << " lines" << std::endl;
+
+  if (result != nullptr)
+  {
+    *result = stats;
+  }
+  return true;
+}
@@ -0,0 +1,25 @@
+#ifndef __PATH_IMPORT_H
+#define __PATH_IMPORT_H
+#include <cstdint>
+#include <string>
+
+// 导入统计
+struct PathImportResult
+{
+  uint64_t bytes = 0;   // 读入的字节数
+  uint64_t lines = 0;   // 非空行数（含表头）
+  uint64_t points = 0;  // 写出的路径点数
+  uint64_t skipped = 0; // 缺少字段、无法解析或时间回退而跳过的行数
+};
+
+// 把 CSV 或 NDJSON 格式的行驶记录流式转换成二进制路径文件（带法向）。
+// 输入按固定大小的块读取，朝向和赛道边界法向随读随算，内存占用与文件大小无关。
+//
+// CSV：首行为表头时按列名取值（x, y, z, t/time/timestamp, yaw/heading，y 和 yaw 可省略），
+//      没有表头时按 x, y, z, timestamp[, yaw] 的顺序；以 # 开头的行忽略
+// NDJSON：每行一个对象，使用与 CSV 表头相同的键名
+// 时间戳换算成相对第一个点的秒数，坐标换算成相对第一个点的偏移（第一个点记为路径原点）；
+// 没有 yaw 时由相邻点的方向计算
+bool import_path_file(const std::string &input_path, const std::string &output_path, PathImportResult *result = nullptr);
+
+#endif
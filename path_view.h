@@ -0,0 +1,34 @@
+#ifndef __PATH_VIEW_H
+#define __PATH_VIEW_H
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+// 路径点
+struct PathPoint
+{
+  glm::vec3 position;
+  float yaw;
+  double timestamp; // 时间戳（秒）。float 在一天（8.6e4 秒）处的间隔已有 7.8 毫秒，长记录会把相邻采样压成同一时刻
+};
+
+// 路径的只读视图：路径点连续存放，可以来自内存中的数组，也可以直接指向映射的路径文件
+struct PathView
+{
+  const PathPoint *points = nullptr;
+  size_t count = 0;
+
+  PathView() = default;
+  PathView(const PathPoint *points, size_t count) : points(points), count(count) {}
+  PathView(const std::vector<PathPoint> &path) : points(path.data()), count(path.size()) {}
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  const PathPoint &operator[](size_t i) const { return points[i]; }
+  const PathPoint &front() const { return points[0]; }
+  const PathPoint &back() const { return points[count - 1]; }
+  const PathPoint *begin() const { return points; }
+  const PathPoint *end() const { return points + count; }
+};
+
+#endif
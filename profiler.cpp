@@ -0,0 +1,337 @@
+#include "profiler.h"
+#include <imgui.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+  // 一组样本的统计，负数（缺失）不计入
+  struct SeriesStats
+  {
+    size_t count = 0;
+    float mean = 0.0f;
+    float p50 = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+    float max = 0.0f;
+  };
+
+  SeriesStats series_stats(const std::vector<float> &values)
+  {
+    std::vector<float> sorted;
+    sorted.reserve(values.size());
+    for (float value : values)
+    {
+      if (value >= 0.0f)
+        sorted.push_back(value);
+    }
+
+    SeriesStats stats;
+    stats.count = sorted.size();
+    if (sorted.empty())
+    {
+      return stats;
+    }
+
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (float value : sorted)
+      sum += value;
+
+    // 最近秩分位数
+    auto rank = [&sorted](float fraction) { return sorted[std::min((size_t)(fraction * sorted.size()), sorted.size() - 1)]; };
+    stats.mean = (float)(sum / sorted.size());
+    stats.p50 = rank(0.50f);
+    stats.p95 = rank(0.95f);
+    stats.p99 = rank(0.99f);
+    stats.max = sorted.back();
+    return stats;
+  }
+
+  void write_series(std::ostream &out, const std::vector<float> &values)
+  {
+    const SeriesStats stats = series_stats(values);
+    out << "{\"count\": " << stats.count << ", \"mean\": " << stats.mean << ", \"p50\": " << stats.p50
+        << ", \"p95\": " << stats.p95 << ", \"p99\": " << stats.p99 << ", \"max\": " << stats.max << ", \"samples\": [";
+    for (size_t i = 0; i < values.size(); i++)
+    {
+      out << (i > 0 ? ", " : "");
+      if (values[i] >= 0.0f)
+        out << values[i];
+      else
+        out << "null";
+    }
+    out << "]}";
+  }
+}
+
+FrameProfiler::~FrameProfiler()
+{
+  for (Section &section : sections_)
+  {
+    glDeleteQueries(2, section.queries);
+  }
+}
+
+void FrameProfiler::begin_frame()
+{
+  // 上一帧的间隔在这一帧开始时才知道；停用期间只更新起点，恢复后的第一个间隔不含停用的时间
+  auto now = std::chrono::steady_clock::now();
+  if (!enabled())
+  {
+    frame_start_ = now;
+    return;
+  }
+
+  if (frame_count_ > 0)
+  {
+    frame_ms_[slot_] = std::chrono::duration<float, std::milli>(now - frame_start_).count();
+  }
+  frame_start_ = now;
+
+  slot_ = frame_count_ % kHistorySize;
+  frame_count_++;
+
+  // 本帧要复用的一组查询是两帧前发出的
+  collect_gpu_results((int)(frame_count_ % 2));
+
+  frame_ms_[slot_] = 0.0f;
+  for (Section &section : sections_)
+  {
+    section.cpu_ms[slot_] = 0.0f;
+    section.gpu_ms[slot_] = -1.0f;
+  }
+}
+
+void FrameProfiler::collect_gpu_results(int parity)
+{
+  for (Section &section : sections_)
+  {
+    if (!section.query_pending[parity])
+      continue;
+    section.query_pending[parity] = false;
+
+    GLint available = 0;
+    glGetQueryObjectiv(section.queries[parity], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+      gpu_dropped_++;
+      continue;
+    }
+
+    GLuint64 elapsed_ns = 0;
+    glGetQueryObjectui64v(section.queries[parity], GL_QUERY_RESULT, &elapsed_ns);
+    section.gpu_ms[section.query_slot[parity]] = (float)(elapsed_ns / 1.0e6);
+  }
+}
+
+int FrameProfiler::find_section(const char *name, bool gpu)
+{
+  for (size_t i = 0; i < sections_.size(); i++)
+  {
+    if (std::strcmp(sections_[i].name.c_str(), name) == 0)
+    {
+      sections_[i].gpu = sections_[i].gpu || gpu;
+      return (int)i;
+    }
+  }
+
+  if (sections_.size() >= kMaxSections)
+  {
+    return -1;
+  }
+
+  Section section;
+  section.name = name;
+  section.depth = depth_;
+  section.gpu = gpu;
+  sections_.push_back(std::move(section));
+  return (int)sections_.size() - 1;
+}
+
+int FrameProfiler::begin_section(const char *name, bool gpu)
+{
+  if (!enabled() || frame_count_ == 0)
+  {
+    return -1;
+  }
+
+  int index = find_section(name, gpu);
+  if (index < 0)
+  {
+    return -1;
+  }
+  depth_++;
+
+  // 同一区段一帧内只计一次 GPU 时间，嵌套在别的 GPU 区段里的也不计
+  const int parity = (int)(frame_count_ % 2);
+  Section &section = sections_[index];
+  if (gpu && gpu_enabled_ && gpu_active_ < 0 && !(section.query_pending[parity] && section.query_slot[parity] == slot_))
+  {
+    if (section.queries[parity] == 0)
+    {
+      glGenQueries(2, section.queries);
+    }
+    glBeginQuery(GL_TIME_ELAPSED, section.queries[parity]);
+    section.query_slot[parity] = slot_;
+    section.query_pending[parity] = true;
+    gpu_active_ = index;
+  }
+
+  return index;
+}
+
+void FrameProfiler::end_section(int section, std::chrono::steady_clock::time_point start)
+{
+  if (section < 0)
+  {
+    return;
+  }
+
+  sections_[section].cpu_ms[slot_] += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+  depth_--;
+
+  if (gpu_active_ == section)
+  {
+    glEndQuery(GL_TIME_ELAPSED);
+    gpu_active_ = -1;
+  }
+}
+
+std::vector<float> FrameProfiler::ordered(const std::vector<float> &history) const
+{
+  // 当前帧还没结束，不计入
+  const size_t count = std::min(frame_count_ > 0 ? frame_count_ - 1 : 0, kHistorySize - 1);
+  std::vector<float> values(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    values[i] = history[(slot_ + kHistorySize - count + i) % kHistorySize];
+  }
+  return values;
+}
+
+void FrameProfiler::render_panel()
+{
+  ImGui::Begin("帧耗时");
+
+  ImGui::Checkbox("启用", &enabled_);
+  ImGui::SameLine();
+  ImGui::Checkbox("GPU 计时", &gpu_enabled_);
+  ImGui::SameLine();
+  ImGui::Checkbox("暂停", &paused_);
+
+  const std::vector<float> frames = ordered(frame_ms_);
+  const SeriesStats frame_stats = series_stats(frames);
+  ImGui::Text("帧间隔: 平均 %.2f ms (%.0f FPS), P50 %.2f, P95 %.2f, P99 %.2f", frame_stats.mean,
+              frame_stats.mean > 0.0f ? 1000.0f / frame_stats.mean : 0.0f, frame_stats.p50, frame_stats.p95, frame_stats.p99);
+  if (!frames.empty())
+  {
+    ImGui::PlotHistogram("##frames", frames.data(), (int)frames.size(), 0, nullptr, 0.0f, std::max(frame_stats.max, 1.0f),
+                         ImVec2(ImGui::GetContentRegionAvail().x, 60.0f));
+  }
+
+  // 各区段的分位数和最近的 CPU 耗时变化
+  if (ImGui::BeginTable("sections", 8, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit))
+  {
+    ImGui::TableSetupColumn("区段");
+    ImGui::TableSetupColumn("CPU P50");
+    ImGui::TableSetupColumn("CPU P95");
+    ImGui::TableSetupColumn("CPU P99");
+    ImGui::TableSetupColumn("GPU P50");
+    ImGui::TableSetupColumn("GPU P95");
+    ImGui::TableSetupColumn("GPU P99");
+    ImGui::TableSetupColumn("CPU 历史", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableHeadersRow();
+
+    for (const Section &section : sections_)
+    {
+      const std::vector<float> cpu = ordered(section.cpu_ms);
+      const SeriesStats cpu_stats = series_stats(cpu);
+
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%*s%s", section.depth * 2, "", section.name.c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", cpu_stats.p50);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", cpu_stats.p95);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", cpu_stats.p99);
+
+      const SeriesStats gpu_stats = series_stats(ordered(section.gpu_ms));
+      for (float value : {gpu_stats.p50, gpu_stats.p95, gpu_stats.p99})
+      {
+        ImGui::TableNextColumn();
+        if (section.gpu && gpu_stats.count > 0)
+          ImGui::Text("%.3f", value);
+        else
+          ImGui::TextDisabled("-");
+      }
+
+      ImGui::TableNextColumn();
+      if (!cpu.empty())
+      {
+        ImGui::PushID(section.name.c_str());
+        ImGui::PlotLines("##history", cpu.data(), (int)cpu.size(), 0, nullptr, 0.0f, std::max(cpu_stats.max, 0.01f),
+                         ImVec2(ImGui::GetContentRegionAvail().x, ImGui::GetTextLineHeight()));
+        ImGui::PopID();
+      }
+    }
+    ImGui::EndTable();
+  }
+
+  ImGui::Text("统计帧数: %zu, GPU 结果未就绪丢弃: %zu", frames.size(), gpu_dropped_);
+
+  static const char *kDumpPath = "frame_profile.json";
+  if (ImGui::Button("导出 JSON"))
+  {
+    if (write_json(kDumpPath))
+    {
+      std::cout << "Frame profile written to " << kDumpPath << std::endl;
+    }
+  }
+  ImGui::SameLine();
+  ImGui::TextDisabled("%s", kDumpPath);
+
+  ImGui::End();
+}
+
+bool FrameProfiler::write_json(const std::string &path) const
+{
+  std::ofstream out(path);
+  if (!out)
+  {
+    std::cout << "ERROR::PROFILER::OUTPUT_NOT_WRITABLE: " << path << std::endl;
+    return false;
+  }
+
+  // 时间单位为毫秒，samples 按帧从旧到新排列，缺失的 GPU 结果为 null
+  out << "{\n"
+      << "  \"frames\": " << ordered(frame_ms_).size() << ",\n"
+      << "  \"gpu_dropped\": " << gpu_dropped_ << ",\n"
+      << "  \"frame_ms\": ";
+  write_series(out, ordered(frame_ms_));
+  out << ",\n"
+      << "  \"sections\": [";
+  for (size_t i = 0; i < sections_.size(); i++)
+  {
+    const Section &section = sections_[i];
+    out << (i > 0 ? "," : "") << "\n"
+        << "    {\"name\": \"" << section.name << "\", \"depth\": " << section.depth << ",\n"
+        << "     \"cpu_ms\": ";
+    write_series(out, ordered(section.cpu_ms));
+    if (section.gpu)
+    {
+      out << ",\n"
+          << "     \"gpu_ms\": ";
+      write_series(out, ordered(section.gpu_ms));
+    }
+    out << "}";
+  }
+  out << "\n  ]\n"
+      << "}" << std::endl;
+
+  return (bool)out;
+}
@@ -0,0 +1,86 @@
+#ifndef __PROFILER_H
+#define __PROFILER_H
+#include <glad/glad.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// 帧耗时统计：按名字区分的区段，每帧记录一次 CPU 耗时，标记了 GPU 的区段同时用 GL_TIME_ELAPSED 查询记录 GPU 耗时。
+// 最近 kHistorySize 帧的数据保存在环形数组中，面板上显示分位数和随时间变化的柱状图，也可以整体导出为 JSON。
+//
+// GPU 查询每个区段两组轮流使用：第 N 帧发出的查询到第 N + 2 帧复用前才读取，这时结果基本都已就绪，
+// 还没就绪的那一帧记为缺失，不会让 CPU 等待 GPU
+class FrameProfiler
+{
+public:
+  static const size_t kHistorySize = 240;
+  static const size_t kMaxSections = 32;
+
+private:
+  struct Section
+  {
+    std::string name;
+    int depth = 0;     // 首次出现时的嵌套深度，面板上据此缩进
+    bool gpu = false;  // 是否带 GPU 计时
+    std::vector<float> cpu_ms = std::vector<float>(kHistorySize, 0.0f);
+    std::vector<float> gpu_ms = std::vector<float>(kHistorySize, -1.0f); // 负数表示这一帧没有结果
+    GLuint queries[2] = {0, 0};
+    size_t query_slot[2] = {0, 0}; // 查询对应的历史槽位
+    bool query_pending[2] = {false, false};
+  };
+
+  std::vector<Section> sections_;
+  std::vector<float> frame_ms_ = std::vector<float>(kHistorySize, 0.0f); // 相邻两帧开始之间的间隔
+  size_t frame_count_ = 0; // 已开始的帧数
+  size_t slot_ = 0;        // 当前帧的历史槽位
+  std::chrono::steady_clock::time_point frame_start_;
+  int depth_ = 0;
+  int gpu_active_ = -1;    // 正在计时的 GPU 区段；GL_TIME_ELAPSED 查询不能嵌套
+  size_t gpu_dropped_ = 0; // 复用前仍未就绪而丢弃的 GPU 结果数
+
+  bool enabled_ = true;
+  bool gpu_enabled_ = true;
+  bool paused_ = false; // 暂停时保留历史，便于查看某一段
+
+public:
+  FrameProfiler() = default;
+  ~FrameProfiler();
+  FrameProfiler(const FrameProfiler &) = delete;
+  FrameProfiler &operator=(const FrameProfiler &) = delete;
+
+  // 每帧开始时调用一次：取回两帧前的 GPU 结果，切换到新的历史槽位
+  void begin_frame();
+
+  int begin_section(const char *name, bool gpu); // 返回区段序号，未计时时返回 -1
+  void end_section(int section, std::chrono::steady_clock::time_point start);
+
+  bool enabled() const { return enabled_ && !paused_; }
+
+  void render_panel();                            // ImGui 面板
+  bool write_json(const std::string &path) const; // 导出最近各帧的数据和分位数
+
+private:
+  int find_section(const char *name, bool gpu);
+  void collect_gpu_results(int parity);
+  std::vector<float> ordered(const std::vector<float> &history) const; // 已结束的各帧，从旧到新
+};
+
+// 作用域计时：构造时开始，析构时结束。gpu 为真时同时计 GPU 时间，只应包住绘制调用
+class ProfileScope
+{
+private:
+  FrameProfiler &profiler_;
+  int section_;
+  std::chrono::steady_clock::time_point start_;
+
+public:
+  ProfileScope(FrameProfiler &profiler, const char *name, bool gpu = false)
+      : profiler_(profiler), section_(profiler.begin_section(name, gpu)), start_(std::chrono::steady_clock::now())
+  {
+  }
+  ~ProfileScope() { profiler_.end_section(section_, start_); }
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef __RING_BUFFER_H
+#define __RING_BUFFER_H
+#include <cstddef>
+#include <vector>
+
+// 固定容量的环形缓冲区：尾部追加 O(1)，写满后覆盖最旧的元素
+// 逻辑下标 0 为最旧的元素，size() - 1 为最新的元素
+template <typename T>
+class RingBuffer
+{
+private:
+  std::vector<T> data_;
+  size_t head_ = 0; // 最旧元素的物理下标
+  size_t size_ = 0;
+  unsigned long long push_count_ = 0; // 累计追加次数，调用方据此得知新增了多少元素
+
+public:
+  explicit RingBuffer(size_t capacity = 0) : data_(capacity) {}
+
+  void push_back(const T &value)
+  {
+    if (data_.empty())
+    {
+      return;
+    }
+
+    push_count_++;
+
+    if (size_ < data_.size())
+    {
+      data_[physical_index(size_)] = value;
+      size_++;
+    }
+    else
+    {
+      // 已满：覆盖最旧的元素，头部后移
+      data_[head_] = value;
+      head_ = physical_index(1);
+    }
+  }
+
+  void clear()
+  {
+    head_ = 0;
+    size_ = 0;
+  }
+
+  // 修改容量，保留最新的元素
+  void set_capacity(size_t capacity)
+  {
+    if (capacity == data_.size())
+    {
+      return;
+    }
+
+    size_t keep = size_ < capacity ? size_ : capacity;
+    std::vector<T> data(capacity);
+    for (size_t i = 0; i < keep; i++)
+    {
+      data[i] = (*this)[size_ - keep + i];
+    }
+
+    data_.swap(data);
+    head_ = 0;
+    size_ = keep;
+  }
+
+  // i 必须小于容量，用一次比较代替取模
+  size_t physical_index(size_t i) const
+  {
+    size_t index = head_ + i;
+    return index < data_.size() ? index : index - data_.size();
+  }
+
+  T &operator[](size_t i) { return data_[physical_index(i)]; }
+  const T &operator[](size_t i) const { return data_[physical_index(i)]; }
+  const T &front() const { return data_[head_]; }
+  const T &back() const { return data_[physical_index(size_ - 1)]; }
+
+  const T *data() const { return data_.data(); } // 物理存储，供整块上传使用
+  size_t head() const { return head_; }
+  unsigned long long push_count() const { return push_count_; }
+  size_t size() const { return size_; }
+  size_t capacity() const { return data_.size(); }
+  bool empty() const { return size_ == 0; }
+  bool full() const { return size_ == data_.size(); }
+};
+
+#endif
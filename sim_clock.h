@@ -0,0 +1,47 @@
+#ifndef __SIM_CLOCK_H
+#define __SIM_CLOCK_H
+
+// 仿真时钟：只随显式传入的 dt 推进，与墙钟、帧率和界面无关，同样的 dt 序列得到逐位相同的时间。
+// 用 double 累加：float 到 1e5 秒时精度已不足 1/120 秒，长路径上每步的增量会被舍入掉。
+// 播放速度只作用于之后的推进，中途改变速度时间不会跳变
+class SimClock
+{
+private:
+  double time_ = 0.0;    // 仿真秒
+  double elapsed_ = 0.0; // 累计推进的仿真秒，不受循环回绕和跳转影响
+  double speed_ = 1.0; // 播放速度倍率
+  bool running_ = false;
+
+public:
+  // 推进 dt 秒墙钟时间，返回实际经过的仿真时间；暂停时不推进
+  double advance(double dt)
+  {
+    if (!running_ || dt <= 0.0)
+    {
+      return 0.0;
+    }
+    const double sim_dt = dt * speed_;
+    time_ += sim_dt;
+    elapsed_ += sim_dt;
+    return sim_dt;
+  }
+
+  void start() { running_ = true; }
+  void pause() { running_ = false; }
+  void reset()
+  {
+    time_ = 0.0;
+    elapsed_ = 0.0;
+    running_ = false;
+  }
+
+  void set_time(double time) { time_ = time; } // 跳转，不改变运行状态
+  void set_speed(double speed) { speed_ = speed; }
+
+  double time() const { return time_; }
+  double elapsed() const { return elapsed_; }
+  double speed() const { return speed_; }
+  bool running() const { return running_; }
+};
+
+#endif
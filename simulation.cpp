@@ -0,0 +1,504 @@
+#include "simulation.h"
+#include "interpolation.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// 转向平滑系数按 60Hz 标定，换算成与步长无关的形式
+static const float kTurnReferenceRate = 60.0f;
+
+// 顺序推进时先线性向前试探的段数，超过后改用二分查找
+static const int kCursorScanLimit = 8;
+
+Simulation::Simulation() : traveled_path_(kDefaultTrailCapacity)
+{
+}
+
+void Simulation::step(double dt)
+{
+  previous_position_ = position_;
+  previous_yaw_angle_ = yaw_angle_;
+
+  if (!clock_.running() || dt <= 0.0)
+  {
+    return;
+  }
+
+  update_path_playback(dt);
+}
+
+int Simulation::advance(double frame_dt)
+{
+  const double fixed_dt = 1.0 / step_rate_;
+
+  // 渲染卡顿时只追赶有限的时间，避免步数越积越多
+  accumulator_ += glm::clamp(frame_dt, 0.0, max_frame_time_);
+
+  int steps = 0;
+  while (accumulator_ >= fixed_dt)
+  {
+    step(fixed_dt);
+    accumulator_ -= fixed_dt;
+    steps++;
+  }
+
+  last_step_count_ = steps;
+  return steps;
+}
+
+void Simulation::snap_render_state()
+{
+  previous_position_ = position_;
+  previous_yaw_angle_ = yaw_angle_;
+}
+
+glm::vec3 Simulation::render_position() const
+{
+  float alpha = glm::clamp((float)(accumulator_ * step_rate_), 0.0f, 1.0f);
+  return glm::mix(previous_position_, position_, alpha);
+}
+
+float Simulation::render_yaw_angle() const
+{
+  float alpha = glm::clamp((float)(accumulator_ * step_rate_), 0.0f, 1.0f);
+  float diff = yaw_angle_ - previous_yaw_angle_;
+
+  // 走最短的角度方向
+  if (diff > 180.0f)
+  {
+    diff -= 360.0f;
+  }
+  else if (diff < -180.0f)
+  {
+    diff += 360.0f;
+  }
+
+  return previous_yaw_angle_ + diff * alpha;
+}
+
+void Simulation::init_predefined_path()
+{
+  // 创建一个简单的圆形赛道，确保在网格范围内（-15到15）
+  predefined_path_.clear();
+
+  const int total_points = 1000;
+  const float total_time = 120.0f; // 总时长120秒
+  const float time_step = total_time / total_points;
+
+  // 圆形赛道参数
+  const float radius = 10.0f; // 半径10，确保在网格范围内
+
+  for (int i = 0; i < total_points; i++)
+  {
+    float t = (float)i / (total_points - 1); // 0.0 到 1.0
+    float time = i * time_step;
+
+    // 圆形的参数方程
+    float angle = t * 2.0f * M_PI; // 完整的一圈，从0到2π
+
+    glm::vec3 position;
+    position.x = radius * cos(angle);
+    position.z = radius * sin(angle);
+    position.y = 0.0f;
+
+    predefined_path_.push_back({position, 0.0f, time});
+  }
+
+  // 自动计算每个路径点的正确朝向
+  calculate_path_orientations();
+
+  path_file_.close();
+  set_path(predefined_path_);
+}
+
+bool Simulation::load_path_file(const std::string &file_path)
+{
+  PathFile path_file;
+  if (!path_file.open(file_path))
+  {
+    return false;
+  }
+
+  // 路径点直接指向映射的文件，朝向已由写入端计算好
+  path_file_.swap(path_file);
+  predefined_path_.clear();
+  set_path(path_file_.view());
+  reset_path_playback();
+  return true;
+}
+
+glm::dvec3 Simulation::path_origin() const
+{
+  if (!path_file_.is_open())
+  {
+    return glm::dvec3(0.0);
+  }
+  const PathOrigin &origin = path_file_.origin();
+  return glm::dvec3(origin.x, origin.y, origin.z);
+}
+
+void Simulation::set_path(const PathView &path)
+{
+  path_ = path;
+  clock_.reset();
+  current_path_index_ = 0;
+}
+
+int Simulation::find_path_segment(double time) const
+{
+  if (path_.size() < 2)
+  {
+    return 0;
+  }
+
+  // 第一个时间戳大于 time 的点的前一个点即为段起点
+  // 直接在路径点上二分，映射的路径文件只会读入查找经过的几页
+  auto it = std::upper_bound(path_.begin(), path_.end(), time,
+                             [](double value, const PathPoint &point) { return value < point.timestamp; });
+  int index = (int)(it - path_.begin()) - 1;
+  return glm::clamp(index, 0, (int)path_.size() - 2);
+}
+
+int Simulation::advance_path_cursor(double time) const
+{
+  const int last_segment = (int)path_.size() - 2;
+  int index = current_path_index_;
+
+  // 时间回退时直接二分查找
+  if (index > last_segment || time < path_[index].timestamp)
+  {
+    return find_path_segment(time);
+  }
+
+  // 顺序播放通常只前进零到几段，先线性试探
+  for (int i = 0; i < kCursorScanLimit; i++)
+  {
+    if (index >= last_segment || time <= path_[index + 1].timestamp)
+    {
+      return index;
+    }
+    index++;
+  }
+
+  return find_path_segment(time);
+}
+
+void Simulation::seek(double time)
+{
+  if (path_.size() < 2)
+  {
+    return;
+  }
+
+  clock_.set_time(glm::clamp(time, 0.0, path_duration()));
+  current_path_index_ = find_path_segment(clock_.time());
+
+  const PathPoint &current_point = path_[current_path_index_];
+  const PathPoint &next_point = path_[current_path_index_ + 1];
+  double segment_duration = next_point.timestamp - current_point.timestamp;
+  float segment_progress =
+      segment_duration > 0.0 ? (float)((clock_.time() - current_point.timestamp) / segment_duration) : 0.0f;
+  segment_progress = glm::clamp(segment_progress, 0.0f, 1.0f);
+
+  // 跳转后轨迹不再连续，直接使用路径朝向
+  position_ = interpolate_position(current_point, next_point, segment_progress);
+  yaw_angle_ = interpolate_yaw(current_point.yaw, next_point.yaw, segment_progress);
+  clear_traveled_path();
+  snap_render_state();
+}
+
+void Simulation::calculate_path_orientations()
+{
+  if (predefined_path_.size() < 2)
+    return;
+
+  // 为每个路径点计算正确的朝向，使用简单而稳定的算法
+  for (size_t i = 0; i < predefined_path_.size(); i++)
+  {
+    glm::vec3 direction;
+
+    if (i == 0)
+    {
+      // 第一个点：朝向下一个点
+      direction = predefined_path_[i + 1].position - predefined_path_[i].position;
+    }
+    else if (i == predefined_path_.size() - 1)
+    {
+      // 最后一个点：朝向第一个点（闭合路径）
+      direction = predefined_path_[0].position - predefined_path_[i].position;
+    }
+    else
+    {
+      // 中间点：朝向下一个点
+      direction = predefined_path_[i + 1].position - predefined_path_[i].position;
+    }
+
+    // 计算yaw角度
+    if (glm::length(direction) > 0.001f)
+    {
+      direction = glm::normalize(direction);
+      float yaw_radians = atan2(direction.x, direction.z);
+      float yaw_degrees = glm::degrees(yaw_radians);
+      predefined_path_[i].yaw = yaw_degrees;
+    }
+    else
+    {
+      // 如果方向向量长度太小，保持前一个点的朝向
+      if (i > 0)
+      {
+        predefined_path_[i].yaw = predefined_path_[i - 1].yaw;
+      }
+      else
+      {
+        predefined_path_[i].yaw = 0.0f;
+      }
+    }
+  }
+
+  // 简单的角度平滑处理
+  for (size_t i = 1; i < predefined_path_.size(); i++)
+  {
+    float prev_yaw = predefined_path_[i - 1].yaw;
+    float curr_yaw = predefined_path_[i].yaw;
+
+    // 处理角度跳跃（例如从179度到-179度）
+    float diff = curr_yaw - prev_yaw;
+
+    if (diff > 180.0f)
+    {
+      predefined_path_[i].yaw -= 360.0f;
+    }
+    else if (diff < -180.0f)
+    {
+      predefined_path_[i].yaw += 360.0f;
+    }
+  }
+}
+
+void Simulation::start_path_playback()
+{
+  if (!path_.empty())
+  {
+    clock_.set_time(0.0);
+    clock_.start();
+    current_path_index_ = 0;
+
+    // 设置初始位置
+    position_ = path_[0].position;
+    yaw_angle_ = path_[0].yaw;
+    snap_render_state();
+  }
+}
+
+void Simulation::resume_path_playback()
+{
+  if (path_.size() >= 2)
+  {
+    clock_.start();
+  }
+}
+
+void Simulation::stop_path_playback()
+{
+  clock_.pause();
+}
+
+void Simulation::reset_path_playback()
+{
+  clock_.reset();
+  current_path_index_ = 0;
+  clear_traveled_path(); // 重置时清空轨迹
+  if (!path_.empty())
+  {
+    position_ = path_[0].position;
+    yaw_angle_ = path_[0].yaw;
+  }
+  snap_render_state();
+}
+
+void Simulation::update_path_playback(double dt)
+{
+  if (!clock_.running() || path_.empty())
+  {
+    return;
+  }
+
+  if (path_.size() < 2)
+  {
+    stop_path_playback();
+    return;
+  }
+
+  // 之后的转向平滑按仿真时间计算，播放加速时转向同样加快
+  const double sim_dt = clock_.advance(dt);
+
+  // 检查是否到达路径末尾
+  bool wrapped = false;
+  if (clock_.time() >= path_duration())
+  {
+    if (loop_play_ && path_duration() > 0.0)
+    {
+      // 循环播放，保留越过终点的时间从头继续
+      clock_.set_time(std::fmod(clock_.time(), path_duration()));
+      current_path_index_ = 0;
+      clear_traveled_path();
+      wrapped = true;
+    }
+    else
+    {
+      // 停止播放
+      stop_path_playback();
+      return;
+    }
+  }
+
+  // 找到当前时间对应的路径段
+  double current_time = clock_.time();
+  current_path_index_ = advance_path_cursor(current_time);
+
+  // 在当前路径段内进行插值
+  const PathPoint &current_point = path_[current_path_index_];
+  const PathPoint &next_point = path_[current_path_index_ + 1];
+
+  // 段内进度在双精度下计算，只有落在 [0, 1] 内的结果才转成 float
+  double segment_duration = next_point.timestamp - current_point.timestamp;
+  float segment_progress =
+      segment_duration > 0.0 ? (float)((current_time - current_point.timestamp) / segment_duration) : 0.0f;
+  segment_progress = glm::clamp(segment_progress, 0.0f, 1.0f);
+
+  // 插值计算当前位置和朝向
+  position_ = interpolate_position(current_point, next_point, segment_progress);
+
+  // 改进：使用更平滑的朝向计算
+  glm::vec3 current_direction = next_point.position - current_point.position;
+
+  // 计算目标朝向，考虑前瞻性转向
+  float target_yaw;
+  if (current_path_index_ + 2 < (int)path_.size())
+  {
+    const PathPoint &next_next_point = path_[current_path_index_ + 2];
+    glm::vec3 future_direction = next_next_point.position - next_point.position;
+
+    // 使用更平滑的前瞻混合
+    float lookahead_factor = glm::smoothstep(0.3f, 1.0f, segment_progress);
+    glm::vec3 blended_direction = glm::mix(current_direction, future_direction, lookahead_factor * 0.3f);
+
+    if (glm::length(blended_direction) > 0.001f)
+    {
+      target_yaw = glm::degrees(atan2(blended_direction.x, blended_direction.z));
+    }
+    else
+    {
+      target_yaw = yaw_angle_; // 保持当前朝向
+    }
+  }
+  else
+  {
+    // 使用当前移动方向
+    if (glm::length(current_direction) > 0.001f)
+    {
+      target_yaw = glm::degrees(atan2(current_direction.x, current_direction.z));
+    }
+    else
+    {
+      target_yaw = yaw_angle_;
+    }
+  }
+
+  // 使用更平滑的插值到目标朝向，动态调整插值速度
+  float turn_speed = 0.08f; // 基础转向速度
+  float angle_diff = std::abs(interpolate_yaw(yaw_angle_, target_yaw, 1.0f) - yaw_angle_);
+
+  // 如果角度差异很大，稍微加快转向速度
+  if (angle_diff > 45.0f)
+  {
+    turn_speed = 0.12f;
+  }
+  else if (angle_diff < 10.0f)
+  {
+    turn_speed = 0.05f; // 小角度时更平滑
+  }
+
+  // 转向速度是每 1/60 秒的混合比例，按实际步长换算，保证不同步长下转向一致
+  turn_speed = 1.0f - std::pow(1.0f - turn_speed, (float)sim_dt * kTurnReferenceRate);
+
+  yaw_angle_ = interpolate_yaw(yaw_angle_, target_yaw, turn_speed);
+
+  // 回到起点属于跳变，不做渲染插值
+  if (wrapped)
+  {
+    snap_render_state();
+  }
+
+  // 更新轨迹记录
+  update_traveled_path();
+}
+
+glm::vec3 Simulation::interpolate_position(const PathPoint &p1, const PathPoint &p2, float t)
+{
+  // 使用平滑的Hermite插值（可以使用线性插值：mix）
+  return glm::mix(p1.position, p2.position, t);
+}
+
+float Simulation::interpolate_yaw(float yaw1, float yaw2, float t)
+{
+  // 沿最短弧插值，结果规整到[-180, 180]（与车队批量插值共用同一套规整方式）
+  return wrap_degrees(yaw1 + shortest_yaw_delta(yaw1, yaw2) * t);
+}
+
+void Simulation::move_forward(float distance)
+{
+  float yaw_rad = glm::radians(yaw_angle_);
+  position_.x += distance * sin(yaw_rad);
+  position_.z += distance * cos(yaw_rad);
+  snap_render_state();
+  update_traveled_path(); // 手动移动时也记录轨迹
+}
+
+void Simulation::turn(float delta_degrees)
+{
+  yaw_angle_ += delta_degrees;
+  if (yaw_angle_ < -180.0f)
+    yaw_angle_ = 180.0f;
+  if (yaw_angle_ > 180.0f)
+    yaw_angle_ = -180.0f;
+  snap_render_state();
+}
+
+void Simulation::set_position(const glm::vec3 &position)
+{
+  position_ = position;
+  snap_render_state();
+}
+
+void Simulation::set_yaw_angle(float yaw_angle)
+{
+  yaw_angle_ = yaw_angle;
+  snap_render_state();
+}
+
+void Simulation::update_traveled_path()
+{
+  // 记录当前位置到轨迹中，使用更小的距离阈值来获得更详细的轨迹
+  if (traveled_path_.empty() ||
+      glm::distance(traveled_path_.back(), position_) > 0.05f)
+  {
+    // 环形缓冲区写满后自动淘汰最旧的点
+    traveled_path_.push_back(position_);
+  }
+}
+
+void Simulation::clear_traveled_path()
+{
+  traveled_path_.clear();
+  traveled_path_generation_++;
+}
+
+void Simulation::set_trail_capacity(size_t capacity)
+{
+  traveled_path_.set_capacity(capacity);
+  traveled_path_generation_++;
+}
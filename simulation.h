@@ -0,0 +1,103 @@
+#ifndef __SIMULATION_H
+#define __SIMULATION_H
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "path_file.h"
+#include "path_view.h"
+#include "ring_buffer.h"
+#include "sim_clock.h"
+
+// 车辆仿真：不依赖窗口、ImGui 和 GL 上下文，只通过 step(dt) 显式推进
+class Simulation
+{
+private:
+  // 车辆状态
+  glm::vec3 position_ = glm::vec3(0.0f, 0.0f, 0.0f);
+  float yaw_angle_ = 0.0f; // 偏航角（左右转动）
+
+  // 固定步长推进相关
+  float step_rate_ = 120.0f;                                  // 仿真频率（Hz）
+  double max_frame_time_ = 0.25;                              // 单帧最多推进的时间，避免卡顿后追赶不及
+  double accumulator_ = 0.0;                                  // 尚未推进的剩余时间
+  int last_step_count_ = 0;                                   // 上一帧执行的仿真步数
+  glm::vec3 previous_position_ = glm::vec3(0.0f, 0.0f, 0.0f); // 上一步的车辆位置，用于渲染插值
+  float previous_yaw_angle_ = 0.0f;                           // 上一步的偏航角
+
+  // 路径播放相关
+  std::vector<PathPoint> predefined_path_; // 预定义路径
+  PathFile path_file_;                     // 映射的路径文件
+  PathView path_;                          // 当前播放的路径（预定义路径或路径文件）
+  SimClock clock_;                         // 播放时间、速度和暂停状态
+  int current_path_index_ = 0;             // 当前路径点索引
+  bool loop_play_ = true;                  // 是否循环播放
+
+  // 路径轨迹相关
+  RingBuffer<glm::vec3> traveled_path_;     // 车子走过的轨迹，写满后覆盖最旧的点
+  unsigned int traveled_path_generation_ = 0; // 轨迹清空或改变容量时递增，渲染端据此整体重传
+
+public:
+  static const size_t kDefaultTrailCapacity = 100000; // 默认轨迹点容量
+
+  Simulation();
+  ~Simulation() = default;
+
+  void step(double dt);         // 推进仿真 dt 秒（墙钟时间，内部乘以播放速度）
+  int advance(double frame_dt); // 按固定步长推进一帧经过的时间，返回执行的步数
+  void snap_render_state();    // 车辆发生跳变时，让渲染插值直接从当前状态开始
+
+  // 路径播放相关方法
+  void init_predefined_path();                                                       // 初始化预定义路径
+  bool load_path_file(const std::string &file_path);                                 // 映射二进制路径文件作为当前路径
+  void calculate_path_orientations();                                                // 计算路径朝向
+  void set_path(const PathView &path);                                               // 切换当前路径，播放游标回到起点
+  int find_path_segment(double time) const;                                          // 二分查找时间所在的路径段
+  int advance_path_cursor(double time) const;                                        // 从当前索引出发查找路径段
+  void seek(double time);                                                            // 跳转到指定播放时间
+  void update_path_playback(double dt);                                              // 播放时钟推进 dt 秒并更新车辆位置
+  void start_path_playback();                                                        // 开始播放
+  void resume_path_playback();                                                       // 从当前时间继续播放
+  void stop_path_playback();                                                         // 停止播放
+  void reset_path_playback();                                                        // 重置播放
+  glm::vec3 interpolate_position(const PathPoint &p1, const PathPoint &p2, float t); // 位置插值
+  float interpolate_yaw(float yaw1, float yaw2, float t);                            // 角度插值
+
+  // 手动控制
+  void move_forward(float distance); // 沿车头方向移动（负值为后退）
+  void turn(float delta_degrees);    // 转向，正值右转
+  void set_position(const glm::vec3 &position);
+  void set_yaw_angle(float yaw_angle);
+
+  // 路径轨迹相关方法
+  void update_traveled_path(); // 更新走过的轨迹
+  void clear_traveled_path();  // 清空轨迹
+  void set_trail_capacity(size_t capacity);
+
+  void set_play_speed(double play_speed) { clock_.set_speed(play_speed); }
+  void set_step_rate(float step_rate) { step_rate_ = step_rate; }
+  void set_max_frame_time(double max_frame_time) { max_frame_time_ = max_frame_time; }
+  void set_loop_play(bool loop_play) { loop_play_ = loop_play; }
+
+  const glm::vec3 &position() const { return position_; }
+  float yaw_angle() const { return yaw_angle_; }
+  glm::vec3 render_position() const; // 在上一步与当前步之间插值的位置
+  float render_yaw_angle() const;     // 在上一步与当前步之间插值的偏航角
+  float step_rate() const { return step_rate_; }
+  int last_step_count() const { return last_step_count_; }
+  bool is_playing() const { return clock_.running(); }
+  double play_time() const { return clock_.time(); }
+  double play_speed() const { return clock_.speed(); }
+  const SimClock &clock() const { return clock_; }
+  bool loop_play() const { return loop_play_; }
+  int current_path_index() const { return current_path_index_; }
+  double path_duration() const { return path_.empty() ? 0.0 : path_.back().timestamp; }
+  const PathView &path() const { return path_; }
+  const PathFile *path_file() const { return path_file_.is_open() ? &path_file_ : nullptr; } // 当前路径不来自文件时为空
+  glm::dvec3 path_origin() const; // 路径原点的世界坐标，位置加上它即为世界坐标；内置路径为 0
+  const RingBuffer<glm::vec3> &traveled_path() const { return traveled_path_; }
+  unsigned int traveled_path_generation() const { return traveled_path_generation_; }
+};
+
+#endif
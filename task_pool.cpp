@@ -0,0 +1,172 @@
+#include "task_pool.h"
+#include <algorithm>
+
+// 工作线程记录自己所属的线程池和队列，用于提交时优先放进自己的队列
+static thread_local const TaskPool *t_pool = nullptr;
+static thread_local size_t t_queue_index = 0;
+
+TaskPool::TaskPool(size_t worker_count)
+{
+  for (size_t i = 0; i < worker_count + 1; i++)
+  {
+    queues_.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+  }
+
+  for (size_t i = 0; i < worker_count; i++)
+  {
+    threads_.emplace_back(&TaskPool::worker_loop, this, i);
+  }
+}
+
+TaskPool::~TaskPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+
+  for (std::thread &thread : threads_)
+  {
+    thread.join();
+  }
+}
+
+size_t TaskPool::default_worker_count()
+{
+  unsigned int hardware_threads = std::thread::hardware_concurrency();
+  return hardware_threads > 1 ? hardware_threads - 1 : 0;
+}
+
+void TaskPool::run(TaskGroup &group, std::function<void()> function)
+{
+  group.pending_.fetch_add(1, std::memory_order_relaxed);
+
+  // 工作线程提交的任务放进自己的队列（后进先出，数据还在缓存里），外部线程轮流分配
+  size_t queue_index = t_pool == this ? t_queue_index : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+  {
+    // 计数在释放队列锁之前增加：取走任务的线程要先拿到同一把锁，减计数总在加计数之后，不会下溢
+    std::lock_guard<std::mutex> lock(queues_[queue_index]->mutex);
+    queues_[queue_index]->tasks.push_back(Task{std::move(function), &group});
+    queued_.fetch_add(1, std::memory_order_release);
+  }
+
+  // 先经过 sleep_mutex_ 再通知，避免工作线程检查完条件、尚未睡下时错过唤醒
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+  }
+  wake_.notify_one();
+}
+
+void TaskPool::wait(TaskGroup &group)
+{
+  const size_t queue_index = current_queue();
+
+  while (!group.done())
+  {
+    Task task;
+    if (pop_task(queue_index, task))
+    {
+      execute(task);
+    }
+    else
+    {
+      // 剩下的任务都在别的线程上执行
+      std::this_thread::yield();
+    }
+  }
+}
+
+void TaskPool::parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)> &body)
+{
+  if (count == 0)
+  {
+    return;
+  }
+
+  grain = std::max<size_t>(grain, 1);
+  if (count <= grain || threads_.empty())
+  {
+    body(0, count);
+    return;
+  }
+
+  TaskGroup group;
+  for (size_t begin = 0; begin < count; begin += grain)
+  {
+    size_t end = std::min(begin + grain, count);
+    run(group, [&body, begin, end]() { body(begin, end); });
+  }
+  wait(group);
+}
+
+size_t TaskPool::current_queue() const
+{
+  return t_pool == this ? t_queue_index : queues_.size() - 1;
+}
+
+bool TaskPool::pop_task(size_t queue_index, Task &task)
+{
+  if (queued_.load(std::memory_order_acquire) == 0)
+  {
+    return false;
+  }
+
+  // 先取自己队列的队尾
+  {
+    WorkerQueue &queue = *queues_[queue_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty())
+    {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      queued_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  // 再从其他队列的队首窃取（最早提交的任务，通常也是最大的）
+  for (size_t i = 1; i < queues_.size(); i++)
+  {
+    WorkerQueue &queue = *queues_[(queue_index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty())
+    {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      queued_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void TaskPool::execute(Task &task)
+{
+  task.function();
+  task.group->pending_.fetch_sub(1, std::memory_order_release);
+}
+
+void TaskPool::worker_loop(size_t queue_index)
+{
+  t_pool = this;
+  t_queue_index = queue_index;
+
+  while (true)
+  {
+    Task task;
+    if (pop_task(queue_index, task))
+    {
+      execute(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [this]() { return stopping_ || queued_.load(std::memory_order_acquire) > 0; });
+    if (stopping_ && queued_.load(std::memory_order_acquire) == 0)
+    {
+      return;
+    }
+  }
+}
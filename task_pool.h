@@ -0,0 +1,75 @@
+#ifndef __TASK_POOL_H
+#define __TASK_POOL_H
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 一组任务的完成计数，TaskPool::wait() 会一直帮忙执行任务直到该组全部完成
+class TaskGroup
+{
+  friend class TaskPool;
+
+private:
+  std::atomic<size_t> pending_{0};
+
+public:
+  bool done() const { return pending_.load(std::memory_order_acquire) == 0; }
+};
+
+// 工作窃取线程池：每个工作线程有自己的任务队列，从队尾取自己提交的任务，
+// 空闲时从其他队列的队首窃取。等待任务组的线程（包括主线程）也参与执行，
+// 所以在任务内部嵌套 parallel_for 不会死锁
+class TaskPool
+{
+private:
+  struct Task
+  {
+    std::function<void()> function;
+    TaskGroup *group;
+  };
+
+  struct WorkerQueue
+  {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_; // 每个工作线程一个，最后一个属于外部线程
+  std::vector<std::thread> threads_;
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  std::atomic<size_t> queued_{0};     // 所有队列中的任务总数
+  std::atomic<size_t> next_queue_{0}; // 外部线程提交时轮流分配到各队列
+  bool stopping_ = false;
+
+public:
+  explicit TaskPool(size_t worker_count = default_worker_count());
+  ~TaskPool();
+  TaskPool(const TaskPool &) = delete;
+  TaskPool &operator=(const TaskPool &) = delete;
+
+  static size_t default_worker_count(); // 硬件线程数减一，调用线程自己也参与执行
+
+  size_t worker_count() const { return threads_.size(); }
+  size_t concurrency() const { return threads_.size() + 1; } // 含调用线程
+
+  void run(TaskGroup &group, std::function<void()> function); // 提交任务，不等待
+  void wait(TaskGroup &group);                                // 等待任务组完成，期间执行队列中的任务
+
+  // 把 [0, count) 按 grain 切块并行执行 body(begin, end)，返回时全部完成
+  void parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)> &body);
+
+private:
+  size_t current_queue() const; // 当前线程对应的队列
+  bool pop_task(size_t queue_index, Task &task);
+  void execute(Task &task);
+  void worker_loop(size_t queue_index);
+};
+
+#endif